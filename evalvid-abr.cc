@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+
+#include "evalvid-abr.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidAbr");
+
+NS_OBJECT_ENSURE_REGISTERED (EvalvidAbr);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidThroughputAbr);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidBbaAbr);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidBolaAbr);
+
+static bool
+RungBitrateLess (double bitrate, const EvalvidAbrRung &rung)
+{
+  return bitrate < rung.bitrate;
+}
+
+static bool
+RungBitrateLessThan (const EvalvidAbrRung &rung, double bitrate)
+{
+  return rung.bitrate < bitrate;
+}
+
+TypeId
+EvalvidAbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidAbr")
+    .SetParent<Object> ()
+    ;
+  return tid;
+}
+
+EvalvidAbr::EvalvidAbr ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EvalvidAbr::~EvalvidAbr ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::vector<EvalvidAbrRung>
+EvalvidAbr::GetDefaultLadder (void)
+{
+  static const struct
+  {
+    double bitrate;
+    double threshold;
+    const char *fileName;
+  } ladder[] = {
+    {  200,  285, "st_foreman_cif_0.2M.st" },
+    {  400,  570, "st_foreman_cif_0.4M.st" },
+    {  600,  850, "st_foreman_cif_0.6M.st" },
+    {  800, 1140, "st_foreman_cif_0.8M.st" },
+    { 1000, 1420, "st_foreman_cif_1M.st" },
+    { 1200, 1710, "st_foreman_cif_1.2M.st" },
+    { 1400, 2000, "st_foreman_cif_1.4M.st" },
+    { 1600, 2280, "st_foreman_cif_1.6M.st" },
+    { 1800, 2570, "st_foreman_cif_1.8M.st" },
+    { 2000, 2850, "st_foreman_cif_2M.st" }
+  };
+
+  std::vector<EvalvidAbrRung> rungs;
+  for (uint32_t i = 0; i < sizeof (ladder) / sizeof (ladder[0]); i++)
+    {
+      EvalvidAbrRung rung;
+      rung.bitrate = ladder[i].bitrate;
+      rung.threshold = ladder[i].threshold;
+      rung.fileName = ladder[i].fileName;
+      rungs.push_back (rung);
+    }
+  return rungs;
+}
+
+void
+EvalvidAbr::SetLadder (const std::vector<EvalvidAbrRung> &ladder)
+{
+  NS_LOG_FUNCTION (this << ladder.size ());
+  NS_ABORT_MSG_IF (ladder.empty (), "EvalvidAbr: empty ladder");
+  for (uint32_t i = 1; i < ladder.size (); i++)
+    {
+      NS_ABORT_MSG_IF (ladder[i].bitrate <= ladder[i - 1].bitrate
+                       || ladder[i].threshold < ladder[i - 1].threshold,
+                       "EvalvidAbr: ladder not sorted at rung " << i);
+    }
+  m_ladder = ladder;
+  DoSetLadder ();
+}
+
+const std::vector<EvalvidAbrRung> &
+EvalvidAbr::GetLadder (void) const
+{
+  return m_ladder;
+}
+
+void
+EvalvidAbr::DoSetLadder (void)
+{
+}
+
+uint32_t
+EvalvidAbr::FindRungAtMost (double bitrate) const
+{
+  std::vector<EvalvidAbrRung>::const_iterator it =
+    std::upper_bound (m_ladder.begin (), m_ladder.end (), bitrate, RungBitrateLess);
+  return it == m_ladder.begin () ? 0 : (it - m_ladder.begin ()) - 1;
+}
+
+uint32_t
+EvalvidAbr::FindRungAtLeast (double bitrate) const
+{
+  std::vector<EvalvidAbrRung>::const_iterator it =
+    std::lower_bound (m_ladder.begin (), m_ladder.end (), bitrate, RungBitrateLessThan);
+  return it == m_ladder.end () ? m_ladder.size () - 1 : it - m_ladder.begin ();
+}
+
+TypeId
+EvalvidThroughputAbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidThroughputAbr")
+    .SetParent<EvalvidAbr> ()
+    .AddConstructor<EvalvidThroughputAbr> ()
+    .AddAttribute ("Scale",
+                   "The requested rate is divided by this value before it is compared "
+                   "with the rung thresholds.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&EvalvidThroughputAbr::m_scale),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidThroughputAbr::EvalvidThroughputAbr ()
+  : m_scale (1.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidThroughputAbr::DoSetLadder (void)
+{
+  m_thresholds.clear ();
+  for (uint32_t i = 0; i < m_ladder.size (); i++)
+    {
+      m_thresholds.push_back (m_ladder[i].threshold);
+    }
+}
+
+uint32_t
+EvalvidThroughputAbr::SelectRendition (const EvalvidAbrInput &input)
+{
+  std::vector<double>::const_iterator it =
+    std::upper_bound (m_thresholds.begin (), m_thresholds.end (), input.requestedRate / m_scale);
+  if (it == m_thresholds.begin ())
+    {
+      return input.current;
+    }
+  return (it - m_thresholds.begin ()) - 1;
+}
+
+TypeId
+EvalvidBbaAbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidBbaAbr")
+    .SetParent<EvalvidAbr> ()
+    .AddConstructor<EvalvidBbaAbr> ()
+    .AddAttribute ("Reservoir",
+                   "Buffer level (s) under which the lowest rung is sent.",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&EvalvidBbaAbr::m_reservoir),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Cushion",
+                   "Buffer range (s) over which the bitrate grows from the lowest "
+                   "to the highest rung.",
+                   DoubleValue (6.0),
+                   MakeDoubleAccessor (&EvalvidBbaAbr::m_cushion),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidBbaAbr::EvalvidBbaAbr ()
+  : m_reservoir (2.0),
+    m_cushion (6.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+EvalvidBbaAbr::SelectRendition (const EvalvidAbrInput &input)
+{
+  uint32_t top = m_ladder.size () - 1;
+  if (input.bufferLevel <= m_reservoir)
+    {
+      return 0;
+    }
+  if (input.bufferLevel >= m_reservoir + m_cushion)
+    {
+      return top;
+    }
+
+  double minRate = m_ladder[0].bitrate;
+  double maxRate = m_ladder[top].bitrate;
+  double rate = minRate + (maxRate - minRate) * (input.bufferLevel - m_reservoir) / m_cushion;
+
+  uint32_t current = input.current > top ? 0 : input.current;
+  double ratePlus = current == top ? maxRate : m_ladder[current + 1].bitrate;
+  double rateMinus = current == 0 ? minRate : m_ladder[current - 1].bitrate;
+  if (rate >= ratePlus)
+    {
+      return FindRungAtMost (rate);
+    }
+  if (rate <= rateMinus)
+    {
+      return FindRungAtLeast (rate);
+    }
+  return current;
+}
+
+TypeId
+EvalvidBolaAbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidBolaAbr")
+    .SetParent<EvalvidAbr> ()
+    .AddConstructor<EvalvidBolaAbr> ()
+    .AddAttribute ("BufferTarget",
+                   "Buffer level (s) at which the highest rung is always sent.",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&EvalvidBolaAbr::m_bufferTarget),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("ChunkDuration",
+                   "Duration (s) of the unit the buffer level is counted in.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&EvalvidBolaAbr::m_chunkDuration),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Gp",
+                   "Weight of playback smoothness against utility (gamma p).",
+                   DoubleValue (5.0),
+                   MakeDoubleAccessor (&EvalvidBolaAbr::m_gp),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidBolaAbr::EvalvidBolaAbr ()
+  : m_bufferTarget (10.0),
+    m_chunkDuration (1.0),
+    m_gp (5.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidBolaAbr::DoSetLadder (void)
+{
+  uint32_t top = m_ladder.size () - 1;
+  double s0 = m_ladder[0].bitrate;
+  double v = (m_bufferTarget / m_chunkDuration - 1) / (std::log (m_ladder[top].bitrate / s0) + m_gp);
+
+  m_switchLevels.clear ();
+  for (uint32_t i = 0; i < top; i++)
+    {
+      double sLow = m_ladder[i].bitrate;
+      double sHigh = m_ladder[i + 1].bitrate;
+      double aLow = v * (std::log (sLow / s0) + m_gp);
+      double aHigh = v * (std::log (sHigh / s0) + m_gp);
+      m_switchLevels.push_back ((aLow * sHigh - aHigh * sLow) / (sHigh - sLow));
+    }
+}
+
+uint32_t
+EvalvidBolaAbr::SelectRendition (const EvalvidAbrInput &input)
+{
+  double q = input.bufferLevel / m_chunkDuration;
+  return std::upper_bound (m_switchLevels.begin (), m_switchLevels.end (), q) - m_switchLevels.begin ();
+}
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_ABR_H__
+#define __EVALVID_ABR_H__
+
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief One rendition of the bitrate ladder.
+ */
+struct EvalvidAbrRung
+{
+  double      bitrate;    //!< Encoding bitrate of the rendition (kbit/s).
+  double      threshold;  //!< Requested rate from which the throughput rule picks it.
+  std::string fileName;   //!< mp4trace file of the rendition.
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief What the server knows when it picks a rendition.
+ */
+struct EvalvidAbrInput
+{
+  double   requestedRate;  //!< Last rate requested by the client.
+  double   throughput;     //!< Last throughput measured by the client (kbit/s).
+  double   bufferLevel;    //!< Playback buffer of the client (s).
+  uint32_t current;        //!< Rung being sent, ladder size if none yet.
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidAbr
+ * \brief Base class of the adaptive bitrate algorithms of EvalvidServer.
+ *
+ * The ladder is sorted by increasing bitrate, and thresholds must not
+ * decrease along it, so that every rule can search it by bisection.
+ */
+class EvalvidAbr : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidAbr ();
+  virtual ~EvalvidAbr ();
+
+  /// \returns the foreman ladder the server used to hard-code
+  static std::vector<EvalvidAbrRung> GetDefaultLadder (void);
+
+  /// \param ladder renditions sorted by increasing bitrate
+  void SetLadder (const std::vector<EvalvidAbrRung> &ladder);
+  const std::vector<EvalvidAbrRung> &GetLadder (void) const;
+
+  /**
+   * \param input state of the client and the server
+   * \returns the rung to send, input.current to keep the current rendition
+   */
+  virtual uint32_t SelectRendition (const EvalvidAbrInput &input) = 0;
+
+protected:
+  /// Called once the ladder is set, to precompute what the rule needs.
+  virtual void DoSetLadder (void);
+
+  /**
+   * \param bitrate bitrate in kbit/s
+   * \returns the highest rung whose bitrate is at most bitrate, 0 if none
+   */
+  uint32_t FindRungAtMost (double bitrate) const;
+
+  /**
+   * \param bitrate bitrate in kbit/s
+   * \returns the lowest rung whose bitrate is at least bitrate, the top rung if none
+   */
+  uint32_t FindRungAtLeast (double bitrate) const;
+
+  std::vector<EvalvidAbrRung> m_ladder;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidThroughputAbr
+ * \brief Picks the highest rung whose threshold the requested rate reaches.
+ *
+ * With the default ladder and a scale of 1 this is the rule EvalvidServer
+ * always used; below the lowest threshold the rendition is kept.
+ */
+class EvalvidThroughputAbr : public EvalvidAbr
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidThroughputAbr ();
+
+  virtual uint32_t SelectRendition (const EvalvidAbrInput &input);
+
+protected:
+  virtual void DoSetLadder (void);
+
+private:
+  double m_scale;
+  std::vector<double> m_thresholds;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidBbaAbr
+ * \brief Buffer-based rule (BBA-0, Huang et al., SIGCOMM 2014).
+ *
+ * The buffer level is mapped linearly onto the ladder bitrates between the
+ * reservoir and the reservoir plus the cushion. The rendition only moves up
+ * when the mapped bitrate reaches the next rung and only moves down when it
+ * falls to the previous one.
+ */
+class EvalvidBbaAbr : public EvalvidAbr
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidBbaAbr ();
+
+  virtual uint32_t SelectRendition (const EvalvidAbrInput &input);
+
+private:
+  double m_reservoir;  // s
+  double m_cushion;    // s
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidBolaAbr
+ * \brief Lyapunov buffer-based rule (BOLA-BASIC, Spiteri et al., INFOCOM 2016).
+ *
+ * The rung maximising (V (u_m + gp) - Q) / S_m, with u_m = ln (S_m / S_0)
+ * and Q the buffer in chunks, only grows with Q, so the buffer levels at
+ * which it changes are computed once per ladder and searched by bisection.
+ */
+class EvalvidBolaAbr : public EvalvidAbr
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidBolaAbr ();
+
+  virtual uint32_t SelectRendition (const EvalvidAbrInput &input);
+
+protected:
+  virtual void DoSetLadder (void);
+
+private:
+  double m_bufferTarget;   // s
+  double m_chunkDuration;  // s
+  double m_gp;
+  std::vector<double> m_switchLevels;  // Q from which rung i + 1 beats rung i
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_ABR_H__
@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+#include "evalvid-buffer-threshold.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidBufferThreshold");
+
+static_assert (sizeof (EvalvidThresholdTableHeader) == 64, "EvalvidThresholdTableHeader must stay packed");
+
+// Abramowitz and Stegun 7.1.26: erfc(x) = t (a1 + t (a2 + ... + t a5)) exp(-x^2), t = 1 / (1 + p x), x >= 0.
+static const double AS_P  = 0.3275911;
+static const double AS_A1 = 0.254829592;
+static const double AS_A2 = -0.284496736;
+static const double AS_A3 = 1.421413741;
+static const double AS_A4 = -1.453152027;
+static const double AS_A5 = 1.061405429;
+
+/// erfc (u) exp (u^2) for u >= 0, the part of 7.1.26 that cannot overflow.
+static inline double
+ScaledErfc (double u)
+{
+  double t = 1.0 / (1.0 + AS_P * u);
+  return t * (AS_A1 + t * (AS_A2 + t * (AS_A3 + t * (AS_A4 + t * AS_A5))));
+}
+
+double
+EvalvidNormalCdf (double x)
+{
+  return 0.5 * std::erfc (-x * M_SQRT1_2);
+}
+
+void
+EvalvidNormalCdf (const double *x, double *cdf, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double u = std::fabs (x[i]) * M_SQRT1_2;
+      double tail = 0.5 * ScaledErfc (u) * std::exp (-u * u);  // P(X <= -|x|)
+      cdf[i] = x[i] < 0 ? tail : 1.0 - tail;
+    }
+}
+
+EvalvidBufferThreshold::EvalvidBufferThreshold ()
+  : m_horizon (10.0),
+    m_target (0.09),
+    m_serviceRate (60),
+    m_serviceVa (0.05),
+    m_bufferSize (4311),  // 5.6 MB of 1362 byte packets
+    m_segments (100),
+    m_overflowWeight (50),
+    m_interruptWeight (0.05),
+    m_delayWeight (0.1),
+    m_delayVarianceWeight (1)
+{
+}
+
+void
+EvalvidBufferThreshold::SetBufferSize (uint32_t packets)
+{
+  m_bufferSize = packets;
+}
+
+uint32_t
+EvalvidBufferThreshold::GetBufferSize (void) const
+{
+  return m_bufferSize;
+}
+
+double
+EvalvidBufferThreshold::GetConstraint (double b, double lamda, double va) const
+{
+  double c;
+  GetConstraint (&b, &c, 1, lamda, va);
+  return c;
+}
+
+double
+EvalvidBufferThreshold::GetObjective (double b, double lamda, double va) const
+{
+  double f;
+  GetObjective (&b, &f, 1, lamda, va);
+  return f;
+}
+
+void
+EvalvidBufferThreshold::GetConstraint (const double *b, double *c, uint32_t n, double lamda, double va) const
+{
+  double beta = lamda;
+  double alpha = lamda * lamda * lamda * va;
+  double sigma = std::sqrt (alpha * m_horizon);
+  double drift = beta * m_horizon;
+  double r = 2 * beta / alpha;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double z1 = (b[i] - drift) / sigma;
+      double z2 = (b[i] + drift) / sigma;
+      // Phi (z1)
+      double u1 = std::fabs (z1) * M_SQRT1_2;
+      double tail1 = 0.5 * ScaledErfc (u1) * std::exp (-u1 * u1);
+      double cdf1 = z1 < 0 ? tail1 : 1.0 - tail1;
+      // exp (r b) Phi (-z2): for z2 >= 0 the exponents combine into -z1^2 / 2,
+      // so the term stays finite where exp (r b) alone overflows.
+      double u2 = std::fabs (z2) * M_SQRT1_2;
+      double scaled = 0.5 * ScaledErfc (u2);
+      double reflected = z2 >= 0
+        ? scaled * std::exp (-z1 * z1 / 2)
+        : std::exp (r * b[i]) - scaled * std::exp (r * b[i] - u2 * u2);
+      c[i] = cdf1 + reflected - m_target;
+    }
+}
+
+void
+EvalvidBufferThreshold::GetObjective (const double *b, double *f, uint32_t n, double lamda, double va) const
+{
+  double u = m_serviceRate;
+  double beta = lamda - u;
+  double alpha = lamda * lamda * lamda * va + u * u * u * m_serviceVa;
+  double r = 2 * beta / alpha;
+  double full = r * (m_bufferSize - 1.0);
+  double expFull = std::exp (full);
+  double expR = std::exp (-r);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double delay = b[i] / lamda;
+      double delayVariance = b[i] * va;
+      // exp (-r b) exp (r (N - 1)) as one exponent, finite where the factors are not.
+      double loss = 1.0 / (-(1 - expR * u * u * b[i] / (lamda * beta * (1 - std::exp (full - r * b[i]))))
+                           + lamda / beta);
+      double charging = 1.0 / (-u / beta
+                               + lamda * lamda * expFull * -std::expm1 (-r * b[i]) / (beta * b[i] * u * (1 - expR)));
+      f[i] = m_overflowWeight * loss + (m_interruptWeight * charging * m_segments) / delay
+        + m_delayWeight * (delay + m_delayVarianceWeight * delayVariance);
+    }
+}
+
+double
+EvalvidBufferThreshold::Optimize (double lamda, double va, uint32_t minB, uint32_t maxB)
+{
+  if (!(lamda > 0 && va > 0) || maxB < minB)
+    {
+      return 0;
+    }
+  uint32_t n = maxB - minB + 1;
+  m_b.resize (n);
+  m_c.resize (n);
+  m_f.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_b[i] = minB + i;
+    }
+  GetConstraint (&m_b[0], &m_c[0], n, lamda, va);
+  GetObjective (&m_b[0], &m_f[0], n, lamda, va);
+
+  double best = 0;
+  double bestCost = std::numeric_limits<double>::infinity ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // NaN costs compare false and are skipped.
+      if (m_c[i] <= 0 && m_f[i] < bestCost)
+        {
+          best = m_b[i];
+          bestCost = m_f[i];
+        }
+    }
+  NS_LOG_DEBUG ("EvalvidBufferThreshold: lamda " << lamda << ", va " << va
+                << ", threshold " << best << ", cost " << bestCost);
+  return best;
+}
+
+EvalvidThresholdTable::EvalvidThresholdTable ()
+{
+  std::memset (&m_header, 0, sizeof (m_header));
+}
+
+void
+EvalvidThresholdTable::Generate (EvalvidBufferThreshold *optimizer,
+                                 double lamdaMin, double lamdaMax, uint32_t nLamda,
+                                 double vaMin, double vaMax, uint32_t nVa,
+                                 uint32_t minB, uint32_t maxB)
+{
+  NS_ABORT_MSG_IF (nLamda < 2 || nVa < 2, "EvalvidThresholdTable: less than 2 points on an axis");
+  NS_ABORT_MSG_IF (!(lamdaMin < lamdaMax) || !(vaMin > 0 && vaMin < vaMax),
+                   "EvalvidThresholdTable: invalid grid");
+  std::memset (&m_header, 0, sizeof (m_header));
+  m_header.magic = EvalvidThresholdTableHeader::MAGIC;
+  m_header.version = EvalvidThresholdTableHeader::VERSION;
+  m_header.recordSize = sizeof (float);
+  m_header.nLamda = nLamda;
+  m_header.nVa = nVa;
+  m_header.bufferSize = optimizer->GetBufferSize ();
+  m_header.minB = minB;
+  m_header.maxB = maxB;
+  m_header.lamdaMin = lamdaMin;
+  m_header.lamdaStep = (lamdaMax - lamdaMin) / (nLamda - 1);
+  m_header.logVaMin = std::log10 (vaMin);
+  m_header.logVaStep = (std::log10 (vaMax) - m_header.logVaMin) / (nVa - 1);
+
+  m_thresholds.resize ((size_t) nLamda * nVa);
+  for (uint32_t i = 0; i < nLamda; i++)
+    {
+      double lamda = lamdaMin + i * m_header.lamdaStep;
+      for (uint32_t j = 0; j < nVa; j++)
+        {
+          double va = std::pow (10.0, m_header.logVaMin + j * m_header.logVaStep);
+          m_thresholds[(size_t) i * nVa + j] = optimizer->Optimize (lamda, va, minB, maxB);
+        }
+    }
+}
+
+bool
+EvalvidThresholdTable::Save (const std::string &fileName) const
+{
+  std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write (reinterpret_cast<const char *> (&m_header), sizeof (m_header));
+  file.write (reinterpret_cast<const char *> (m_thresholds.data ()),
+              (std::streamsize) m_thresholds.size () * sizeof (float));
+  file.close ();
+  return !file.fail ();
+}
+
+bool
+EvalvidThresholdTable::Load (const std::string &fileName)
+{
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  EvalvidThresholdTableHeader header;
+  if (!file.read (reinterpret_cast<char *> (&header), sizeof (header))
+      || header.magic != EvalvidThresholdTableHeader::MAGIC
+      || header.version != EvalvidThresholdTableHeader::VERSION
+      || header.recordSize != sizeof (float)
+      || header.nLamda < 2 || header.nVa < 2)
+    {
+      NS_LOG_WARN (">> EvalvidThresholdTable: Not a threshold table: " << fileName);
+      return false;
+    }
+  std::vector<float> thresholds ((size_t) header.nLamda * header.nVa);
+  if (!file.read (reinterpret_cast<char *> (&thresholds[0]),
+                  (std::streamsize) thresholds.size () * sizeof (float)))
+    {
+      NS_LOG_WARN (">> EvalvidThresholdTable: Truncated threshold table: " << fileName);
+      return false;
+    }
+  m_header = header;
+  m_thresholds.swap (thresholds);
+  NS_LOG_INFO (">> EvalvidThresholdTable: " << fileName << ": " << m_header.nLamda << " x "
+               << m_header.nVa << " thresholds for a buffer of " << m_header.bufferSize << " packets");
+  return true;
+}
+
+bool
+EvalvidThresholdTable::IsEmpty (void) const
+{
+  return m_thresholds.empty ();
+}
+
+uint32_t
+EvalvidThresholdTable::GetBufferSize (void) const
+{
+  return m_header.bufferSize;
+}
+
+double
+EvalvidThresholdTable::Lookup (double lamda, double va) const
+{
+  if (m_thresholds.empty () || !(va > 0))
+    {
+      return 0;
+    }
+  double x = (lamda - m_header.lamdaMin) / m_header.lamdaStep;
+  double y = (std::log10 (va) - m_header.logVaMin) / m_header.logVaStep;
+  x = std::min (std::max (x, 0.0), m_header.nLamda - 1.0);
+  y = std::min (std::max (y, 0.0), m_header.nVa - 1.0);
+  uint32_t i = std::min<uint32_t> ((uint32_t) x, m_header.nLamda - 2);
+  uint32_t j = std::min<uint32_t> ((uint32_t) y, m_header.nVa - 2);
+  double dx = x - i;
+  double dy = y - j;
+
+  const float *row = &m_thresholds[(size_t) i * m_header.nVa + j];
+  double b00 = row[0];
+  double b01 = row[1];
+  double b10 = row[m_header.nVa];
+  double b11 = row[m_header.nVa + 1];
+  if (b00 == 0 || b01 == 0 || b10 == 0 || b11 == 0)
+    {
+      // Interpolating towards an infeasible point (0) would invent a
+      // threshold; take the nearest grid point instead.
+      return row[(dx < 0.5 ? 0 : m_header.nVa) + (dy < 0.5 ? 0 : 1)];
+    }
+  return (1 - dx) * ((1 - dy) * b00 + dy * b01) + dx * ((1 - dy) * b10 + dy * b11);
+}
+
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_BUFFER_THRESHOLD_H__
+#define __EVALVID_BUFFER_THRESHOLD_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief standard normal cumulative distribution function
+ * \param x the point
+ * \returns P(X <= x) for X ~ N(0, 1), from std::erfc
+ */
+double EvalvidNormalCdf (double x);
+
+/**
+ * \ingroup Evalvid
+ * \brief standard normal cumulative distribution function of n points
+ *
+ * Abramowitz and Stegun 7.1.26, absolute error below 1.5e-7. The loop is
+ * branch-free over contiguous arrays so that the compiler vectorizes it.
+ *
+ * \param x the points
+ * \param cdf receives P(X <= x[i]); may be x
+ * \param n number of points
+ */
+void EvalvidNormalCdf (const double *x, double *cdf, uint32_t n);
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidBufferThreshold
+ * \brief Playback threshold optimizer of EvalvidClient.
+ *
+ * Packets arrive at the playback buffer as a Brownian motion of drift lamda
+ * and variance lamda^3 va per statistics interval. The charging probability
+ * of a threshold b is the probability that the buffer reaches b packets
+ * within the horizon; thresholds are feasible while it stays below the
+ * target. Among the feasible thresholds, Optimize picks the one minimizing
+ * the weighted cost of buffer overflow, playback interruptions and start-up
+ * delay. Both functions are evaluated for all candidate thresholds at once.
+ */
+class EvalvidBufferThreshold
+{
+public:
+  EvalvidBufferThreshold ();
+
+  /// \param packets capacity of the playback buffer in packets
+  void SetBufferSize (uint32_t packets);
+  uint32_t GetBufferSize (void) const;
+
+  /**
+   * \param b threshold in packets
+   * \param lamda mean arrivals per interval
+   * \param va arrival variance coefficient
+   * \returns the charging probability of b minus the target; b is feasible if it is <= 0
+   */
+  double GetConstraint (double b, double lamda, double va) const;
+  /// \returns the cost of threshold b, see GetConstraint for the parameters
+  double GetObjective (double b, double lamda, double va) const;
+
+  /// GetConstraint of the n thresholds b into c.
+  void GetConstraint (const double *b, double *c, uint32_t n, double lamda, double va) const;
+  /// GetObjective of the n thresholds b into f.
+  void GetObjective (const double *b, double *f, uint32_t n, double lamda, double va) const;
+
+  /**
+   * \brief search the integer thresholds of [minB, maxB]
+   * \param lamda mean arrivals per interval
+   * \param va arrival variance coefficient
+   * \param minB smallest candidate
+   * \param maxB largest candidate
+   * \returns the feasible threshold of least cost, or 0 if none is feasible
+   */
+  double Optimize (double lamda, double va, uint32_t minB, uint32_t maxB);
+
+private:
+  double m_horizon;       //!< Horizon of the charging probability (intervals).
+  double m_target;        //!< Largest acceptable charging probability.
+  double m_serviceRate;   //!< Mean playout per interval (packets).
+  double m_serviceVa;     //!< Playout variance coefficient.
+  uint32_t m_bufferSize;  //!< Playback buffer capacity (packets).
+  uint32_t m_segments;
+  double m_overflowWeight;
+  double m_interruptWeight;
+  double m_delayWeight;
+  double m_delayVarianceWeight;
+  // Scratch of Optimize, kept to avoid allocating every search.
+  std::vector<double> m_b;
+  std::vector<double> m_c;
+  std::vector<double> m_f;
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief Header of a threshold table file, followed by nLamda * nVa floats.
+ *
+ * The thresholds are stored row by row, one row per arrival rate. Like
+ * binary traces, tables are written in host byte order.
+ */
+struct EvalvidThresholdTableHeader
+{
+  static const uint32_t MAGIC = 0x45565448;  //!< "EVTH"
+  static const uint16_t VERSION = 1;
+
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;  //!< sizeof (float) of the writer.
+  uint32_t nLamda;
+  uint32_t nVa;
+  uint32_t bufferSize;  //!< Buffer size (packets) the table was computed for.
+  uint32_t minB;
+  uint32_t maxB;
+  uint32_t reserved;
+  double   lamdaMin;
+  double   lamdaStep;
+  double   logVaMin;    //!< log10 of the first va.
+  double   logVaStep;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidThresholdTable
+ * \brief Optimal playback thresholds precomputed over a grid of arrival statistics.
+ *
+ * The table is generated offline by evalvid-threshold-table-generator,
+ * which runs EvalvidBufferThreshold::Optimize at every grid point, and is
+ * loaded by EvalvidClient at start. The arrival rate axis is linear and the
+ * variance coefficient axis logarithmic, as va spans decades. Lookup
+ * interpolates the four neighbouring thresholds in constant time; inputs
+ * outside of the grid are clamped to its border.
+ */
+class EvalvidThresholdTable
+{
+public:
+  EvalvidThresholdTable ();
+
+  /**
+   * \brief fill the table with the thresholds of optimizer
+   * \param optimizer the optimizer, with its buffer size set
+   * \param lamdaMin first arrival rate
+   * \param lamdaMax last arrival rate
+   * \param nLamda number of arrival rates, at least 2
+   * \param vaMin first variance coefficient
+   * \param vaMax last variance coefficient
+   * \param nVa number of variance coefficients, at least 2
+   * \param minB smallest candidate threshold
+   * \param maxB largest candidate threshold
+   */
+  void Generate (EvalvidBufferThreshold *optimizer,
+                 double lamdaMin, double lamdaMax, uint32_t nLamda,
+                 double vaMin, double vaMax, uint32_t nVa,
+                 uint32_t minB, uint32_t maxB);
+
+  /// \returns false if the file cannot be written
+  bool Save (const std::string &fileName) const;
+  /// \returns false if the file cannot be read or is not a threshold table
+  bool Load (const std::string &fileName);
+
+  bool IsEmpty (void) const;
+  uint32_t GetBufferSize (void) const;
+
+  /**
+   * \param lamda mean arrivals per interval
+   * \param va arrival variance coefficient
+   * \returns the interpolated threshold, or 0 if no threshold near the point is feasible
+   */
+  double Lookup (double lamda, double va) const;
+
+private:
+  EvalvidThresholdTableHeader m_header;
+  std::vector<float> m_thresholds;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_BUFFER_THRESHOLD_H__
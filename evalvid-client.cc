@@ -27,13 +27,24 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/node.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-rrc.h"
 #include "evalvid-client.h"
+#include "evalvid-frame-registry.h"
+#include "evalvid-feedback-header.h"
+#include "evalvid-request-header.h"
+#include "evalvid-frame-header.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/qos-tag.h"
 #include <math.h>
+#include <sstream>
 
 
 namespace ns3 {
@@ -56,11 +67,105 @@ EvalvidClient::GetTypeId (void)
                    UintegerValue (100),
                    MakeUintegerAccessor (&EvalvidClient::m_peerPort),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("BearerCellId",
+                   "Cell of the LTE bearer the video is received over, sent with the streaming "
+                   "request, as RNTIs are unique within a cell only. "
+                   "0 takes the cell of the LTE UE device of the node.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EvalvidClient::m_bearerCellId),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("BearerRnti",
+                   "RNTI of the LTE bearer the video is received over, sent with the streaming "
+                   "request so that the server follows the congestion hints of that bearer. "
+                   "0 takes the RNTI of the LTE UE device of the node.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EvalvidClient::m_bearerRnti),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("BearerLcid",
+                   "LCID of the LTE bearer the video is received over, 0 for any bearer of the RNTI.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EvalvidClient::m_bearerLcid),
+                   MakeUintegerChecker<uint8_t> ())
     .AddAttribute ("ReceiverDumpFilename",
                    "Receiver Dump Filename",
                    StringValue(""),
                    MakeStringAccessor(&EvalvidClient::receiverDumpFileName),
                    MakeStringChecker())
+    .AddAttribute ("BinaryDump",
+                   "Write the receiver dump as binary records, to be converted to the "
+                   "Evalvid text by evalvid-dump-converter.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidClient::m_binaryDump),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncOutput",
+                   "Format and write the receiver dump and thoughoutFile on the "
+                   "EvalvidOutputThread. videoRate is always written line by line, for "
+                   "servers in legacy file signalling mode.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&EvalvidClient::m_asyncOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AdaptiveThreshold",
+                   "Recompute the playback threshold from the packet arrival statistics "
+                   "after every bitrate change, instead of keeping 200 packets.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&EvalvidClient::m_adaptiveThreshold),
+                   MakeBooleanChecker ())
+    .AddAttribute ("StatisticsWindow",
+                   "Number of 0.2 s intervals of the sliding window of packet arrival "
+                   "statistics the adaptive threshold is computed from.",
+                   UintegerValue (25),
+                   MakeUintegerAccessor (&EvalvidClient::m_statisticsWindow),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ThresholdTable",
+                   "Table of optimal thresholds written by evalvid-threshold-table-generator. "
+                   "The adaptive threshold is then interpolated from it instead of searched.",
+                   StringValue (""),
+                   MakeStringAccessor (&EvalvidClient::m_thresholdTableFileName),
+                   MakeStringChecker ())
+    .AddAttribute ("PlayoutFrameRate",
+                   "Frames per second played out of the playback buffer until the frame "
+                   "header of a played frame tells its interval in the trace.",
+                   DoubleValue (30.0),
+                   MakeDoubleAccessor (&EvalvidClient::m_playoutFrameRate),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("FrameTrackerCapacity",
+                   "Number of frames ahead of the playout whose fragments are tracked.",
+                   UintegerValue (8192),
+                   MakeUintegerAccessor (&EvalvidClient::m_frameTrackerCapacity),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("QoeWindow",
+                   "Length (s) of the windows of the ITU-T P.1201 MOS time series.",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&EvalvidClient::m_qoeWindow),
+                   MakeDoubleChecker<double> (0.1))
+    .AddAttribute ("ThroughputEstimatorType",
+                   "Type of the EvalvidThroughputEstimator turning the throughput measured "
+                   "every 0.2 s into the estimate the bitrate shifts and feedback use.",
+                   TypeIdValue (EvalvidLastSampleEstimator::GetTypeId ()),
+                   MakeTypeIdAccessor (&EvalvidClient::m_estimatorType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("LegacyFileSignalling",
+                   "Take frame and chunk information from the videoType1 and bitRate files "
+                   "written by EvalvidServer instead of the in-band frame header. "
+                   "The files are read incrementally.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidClient::m_legacyFileSignalling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ClientId",
+                   "Id of the client at its server, sent with the request. A non zero id "
+                   "suffixes the videoRate and thoughoutFile outputs, and the videoType1, "
+                   "bitRate and sender dump the server writes for the client, with _<id>. "
+                   "Clients of one server need distinct ids in legacy file signalling mode.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EvalvidClient::m_clientId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("FramePlayed",
+                     "A video frame was played: frame number, frame type and "
+                     "EvalvidFrameTracker::FrameStatus.",
+                     MakeTraceSourceAccessor (&EvalvidClient::m_framePlayedTrace))
+    .AddTraceSource ("WindowMos",
+                     "A window of QoeWindow seconds ended: its ITU-T P.1201 MOS.",
+                     MakeTraceSourceAccessor (&EvalvidClient::m_windowMosTrace))
     ;
   return tid;
 }
@@ -69,38 +174,54 @@ EvalvidClient::EvalvidClient ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_sendEvent = EventId ();
+  m_bearerCellId = 0;
+  m_bearerRnti = 0;
+  m_bearerLcid = 0;
   m_time = -1;
   m_sumThoughout = 0;
   m_count = 0;
   m_flag = 0;
+  m_bitrate = 0.0;
+  m_data = 0.0;
+  m_thoughout = 0.0;
+  m_requestedRate = 0.0;
+  m_oldFrameNo = 0;
   m_lastFrame = 0;
   m_encoderSize = 0.0;
   m_oneSdata = 0.0;
   X = 0.0;
   m_interrupDuration = 0.0;
+  m_interrupTime = 0.0;
+  m_interruptCnt = 0;
+  m_interruptFlag = 0;
+  m_overflowTime = 0.0;
+  m_overflowCnt = 0;
+  m_overflowFlag = 0;
+  m_overflowDuration = 0.0;
+  m_playoutFrameRate = 30.0;
+  m_frameInterval = 0.0;
+  m_playoutEvent = EventId ();
+  m_frameTrackerCapacity = 8192;
+  m_qoeWindow = 10.0;
+  m_qoeEvent = EventId ();
   m_videoRateFileName = "videoRate";
+  m_clientId = 0;
   m_maxPBuf = 5.6 * 1024 * 1024; // 10M Bytes, 5.56
   m_pBuf = 0.0;
-  m_iter = 0; // iteration flag, 1 : stop
-  m_objf = 1e10;
-  m_c = 0;
   m_intervalNum = 0;
   m_avgPktSize = 1362;
   m_b = 200; // initial value 15, packets number,200 overflow
+  m_adaptiveThreshold = true;
+  m_lamda = 0;
+  m_va = 0.05;
+  m_statisticsWindow = 25;
   m_detechCnt = 0;
-  m_videoRateFile.open(m_videoRateFileName.c_str(), ios::out);
-  if (m_videoRateFile.fail())
-   {
-     NS_FATAL_ERROR(">> EvalvidServer: Error while opening video rate file: " << m_videoRateFileName.c_str());
-     return;
-   }
+  m_legacyFileSignalling = false;
+  m_binaryDump = false;
+  m_asyncOutput = true;
+  m_legacyBitrate = 0.0;
+  m_legacyChunkStartFrame = 0;
   m_thoughoutFileName = "thoughoutFile";
-  m_thoughoutFile.open(m_thoughoutFileName.c_str(), ios::out);
-  if (m_thoughoutFile.fail())
-   {
-     NS_FATAL_ERROR(">> EvalvidServer: Error while opening video rate file: " << m_thoughoutFileName.c_str());
-     return;
-   }
 }
 
 EvalvidClient::~EvalvidClient ()
@@ -115,10 +236,23 @@ EvalvidClient::SetRemote (Ipv4Address ip, uint16_t port)
   m_peerPort = port;
 }
 
+double
+EvalvidClient::GetSessionMos (void) const
+{
+  return m_qoe.GetSessionMos ();
+}
+
+EvalvidQoeInputs
+EvalvidClient::GetQoeInputs (void) const
+{
+  return m_qoe.GetSessionInputs ();
+}
+
 void
 EvalvidClient::DoDispose (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_estimator = 0;
   Application::DoDispose ();
 }
 
@@ -136,15 +270,56 @@ EvalvidClient::StartApplication (void)
     }
 
 
-  receiverDumpFile.open(receiverDumpFileName.c_str(), ios::out);
-  if (receiverDumpFile.fail())
+  if (!receiverDumpFile.Open (receiverDumpFileName, EvalvidDumpWriter::PACKET_DUMP, m_binaryDump,
+                              1 << 20, m_asyncOutput))
     {
       NS_FATAL_ERROR(">> EvalvidClient: Error while opening output file: " << receiverDumpFileName.c_str());
       return;
     }
+  // Written line by line, for the servers following it.
+  string suffix = GetFileSuffix ();
+  if (!m_videoRateFile.Open (m_videoRateFileName + suffix, EvalvidDumpWriter::RATE_DUMP, false, 0, false))
+   {
+     NS_FATAL_ERROR(">> EvalvidServer: Error while opening video rate file: " << (m_videoRateFileName + suffix).c_str());
+     return;
+   }
+  if (!m_thoughoutFile.Open (m_thoughoutFileName + suffix, EvalvidDumpWriter::THROUGHPUT_DUMP, false,
+                             m_asyncOutput ? 1 << 16 : 0, m_asyncOutput))
+   {
+     NS_FATAL_ERROR(">> EvalvidServer: Error while opening video rate file: " << (m_thoughoutFileName + suffix).c_str());
+     return;
+   }
+
+  ObjectFactory estimatorFactory;
+  estimatorFactory.SetTypeId (m_estimatorType);
+  m_estimator = estimatorFactory.Create<EvalvidThroughputEstimator> ();
+  m_arrivalStats.SetWindow (m_statisticsWindow);
+  m_frameTracker.SetCapacity (m_frameTrackerCapacity);
+  m_frameTracker.SetFrameCallback (MakeCallback (&EvalvidClient::HandleFramePlayed, this));
+  m_bufferThreshold.SetBufferSize (m_maxPBuf / m_avgPktSize);
+  if (!m_thresholdTableFileName.empty ())
+    {
+      if (!m_thresholdTable.Load (m_thresholdTableFileName))
+        {
+          NS_FATAL_ERROR(">> EvalvidClient: Error while loading threshold table: " << m_thresholdTableFileName);
+        }
+      if (m_thresholdTable.GetBufferSize () != m_bufferThreshold.GetBufferSize ())
+        {
+          NS_LOG_WARN(">> EvalvidClient: Threshold table computed for a buffer of "
+                      << m_thresholdTable.GetBufferSize () << " packets instead of "
+                      << m_bufferThreshold.GetBufferSize ());
+        }
+    }
 
   m_socket->SetRecvCallback (MakeCallback (&EvalvidClient::HandleRead, this));
 
+  if (m_legacyFileSignalling)
+    {
+      m_videoTypeReader.SetFileName ("videoType1" + suffix);
+      m_videoTypeReader.SetLineCallback (MakeCallback (&EvalvidClient::HandleVideoTypeLine, this));
+      m_bitRateReader.SetFileName ("bitRate" + suffix);
+    }
+
   //Delay requesting to get server on line.
   m_sendEvent = Simulator::Schedule ( Seconds(0.1) , &EvalvidClient::Send, this);
 
@@ -157,6 +332,14 @@ EvalvidClient::Send (void)
 
   Ptr<Packet> p = Create<Packet> ();
 
+  EvalvidRequestHeader request;
+  Ptr<LteUeRrc> rrc = GetUeRrc ();
+  request.SetCellId (m_bearerCellId != 0 || rrc == 0 ? m_bearerCellId : rrc->GetCellId ());
+  request.SetRnti (m_bearerRnti != 0 || rrc == 0 ? m_bearerRnti : rrc->GetRnti ());
+  request.SetLcid (m_bearerLcid);
+  request.SetClientId (m_clientId);
+  request.SetFollowFiles (m_legacyFileSignalling);
+  p->AddHeader (request);
   SeqTsHeader seqTs;
   seqTs.SetSeq (0);
   p->AddHeader (seqTs);
@@ -164,16 +347,168 @@ EvalvidClient::Send (void)
   m_socket->Send (p);
 
   NS_LOG_INFO (">> EvalvidClient: Sending request for video streaming to EvalvidServer at "
-                << m_peerAddress << ":" << m_peerPort);
+                << m_peerAddress << ":" << m_peerPort << ", bearer " << request);
+}
+
+string
+EvalvidClient::GetFileSuffix (void) const
+{
+  std::ostringstream suffix;
+  if (m_clientId != 0)
+    {
+      suffix << "_" << m_clientId;
+    }
+  return suffix.str ();
+}
+
+Ptr<LteUeRrc>
+EvalvidClient::GetUeRrc (void) const
+{
+  Ptr<Node> node = GetNode ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<LteUeNetDevice> device = DynamicCast<LteUeNetDevice> (node->GetDevice (i));
+      if (device != 0 && device->GetRrc () != 0)
+        {
+          return device->GetRrc ();
+        }
+    }
+  return 0;
+}
+
+void
+EvalvidClient::SendFeedback (double rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+
+  m_requestedRate = rate;
+  SendStatus ();
+
+  // Kept as an output for external tools, the server no longer reads it.
+  m_videoRateFile.WriteRate (rate);
+}
+
+void
+EvalvidClient::SendStatus (void)
+{
+  EvalvidFeedbackHeader feedback;
+  feedback.SetRequestedBitrate (m_requestedRate);
+  feedback.SetThroughput (m_thoughout);
+  feedback.SetBufferLevel ((uint32_t) m_pBuf);
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (feedback);
+  m_socket->Send (p);
 }
 
+void
+EvalvidClient::HandleVideoTypeLine (const std::string &line)
+{
+  EvalvidPacketInfo info;
+  istringstream fields (line);
+  if (fields >> info.packetId >> info.uid >> info.frameId >> info.frameType >> info.frameSize)
+    {
+      m_legacyRegistry.Add (info);
+    }
+}
 
 void
 EvalvidClient::StopApplication ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  receiverDumpFile.close();
+  receiverDumpFile.Close ();
+  m_videoRateFile.Close ();
+  m_thoughoutFile.Close ();
   Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_playoutEvent);
+  Simulator::Cancel (m_qoeEvent);
+
+  /* close the interruption or overflow the session ends in */
+  double time = Simulator::Now ().ToDouble (ns3::Time::S);
+  if (1 == m_interruptFlag) {
+    m_interrupDuration += (time - m_interrupTime);
+    m_interruptFlag = 0;
+  }
+  if (1 == m_overflowFlag) {
+    m_overflowDuration += (time - m_overflowTime);
+    m_overflowFlag = 0;
+  }
+  NS_LOG_INFO(">> EvalvidClient: " << m_interruptCnt << " interruptions, " << m_interrupDuration
+              << "s interrupted, " << m_overflowCnt << " overflows, " << m_overflowDuration << "s overflowed");
+  NS_LOG_INFO(">> EvalvidClient: " << m_frameTracker.GetNPlayed () << " frames played, decodable frame rate "
+              << m_frameTracker.GetDecodableFrameRate ()
+              << ", partial " << m_frameTracker.GetNFrames (EvalvidFrameTracker::FRAME_PARTIAL)
+              << ", late " << m_frameTracker.GetNFrames (EvalvidFrameTracker::FRAME_LATE)
+              << ", undecodable " << m_frameTracker.GetNFrames (EvalvidFrameTracker::FRAME_UNDECODABLE)
+              << ", lost " << m_frameTracker.GetNFrames (EvalvidFrameTracker::FRAME_LOST));
+  if (m_qoe.IsStarted ())
+    {
+      double mos = m_qoe.Finish (time);
+      NS_LOG_INFO(">> EvalvidClient: session MOS " << mos << " over "
+                  << m_qoe.GetWindows ().size () << " windows of " << m_qoeWindow << "s");
+    }
+}
+
+void
+EvalvidClient::EndQoeWindow (void)
+{
+  double time = Simulator::Now ().ToDouble (ns3::Time::S);
+  double mos = m_qoe.EndWindow (time);
+  NS_LOG_DEBUG(">> MOS of the window ending at " << time << ": " << mos);
+  m_windowMosTrace (mos);
+  m_qoeEvent = Simulator::Schedule (Seconds (m_qoeWindow), &EvalvidClient::EndQoeWindow, this);
+}
+
+void
+EvalvidClient::HandleFramePlayed (uint32_t frameNo, EvalvidFrameTag::FrameType frameType,
+                                  EvalvidFrameTracker::FrameStatus status)
+{
+  NS_LOG_DEBUG(">> Frame played: " << frameNo << "\t" << EvalvidFrameTag::GetFrameTypeString (frameType)
+               << "\t" << EvalvidFrameTracker::GetStatusString (status));
+  m_framePlayedTrace (frameNo, frameType, status);
+  if (frameType != EvalvidFrameTag::H_FRAME)
+    {
+      m_qoe.NotifyFrame (status == EvalvidFrameTracker::FRAME_COMPLETE);
+    }
+}
+
+void
+EvalvidClient::PlayFrame (void)
+{
+  double time = Simulator::Now ().ToDouble (ns3::Time::S);
+  /* playback interruption happens, calculate the playback interruption */
+  if (m_pBuf < m_b*m_avgPktSize) {
+    m_interrupTime = time;
+    NS_LOG_DEBUG(">> Interruption happens, bitrate: " << m_bitrate
+                 << "\ttime: " << m_interrupTime << std::endl);
+    m_interruptCnt ++;
+    m_interruptFlag = 1;
+    m_qoe.StallStart (time);
+    return; // HandleRead resumes the playout
+  }
+  /* no interruption, play one frame and drain the bytes received for it */
+  m_frameTracker.PlayFrame ();
+  m_pBuf -= m_frameTracker.GetPlayedBytes ();
+  if (m_frameTracker.GetPlayedInterval () != 0) {
+    m_frameInterval = m_frameTracker.GetPlayedInterval () / 1e6;
+  }
+  if (m_pBuf < 0) {
+    m_pBuf = 0;
+  }
+  if (1 == m_overflowFlag && m_pBuf < m_maxPBuf) {
+    m_overflowDuration += (time - m_overflowTime);
+    NS_LOG_DEBUG(">> Overflow finished: Current overflow time " << (time - m_overflowTime)
+                 << "\tsum of overflow time: " << m_overflowDuration << std::endl);
+    m_overflowFlag = 0;
+    m_qoe.OverflowEnd (time);
+  }
+  m_playoutEvent = Simulator::Schedule (Seconds (GetPlayoutPeriod ()), &EvalvidClient::PlayFrame, this);
+}
+
+double
+EvalvidClient::GetPlayoutPeriod (void) const
+{
+  return m_frameInterval > 0 ? m_frameInterval : 1.0 / m_playoutFrameRate;
 }
 
 void
@@ -196,12 +531,16 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                            << "s\tid: " << packetId
                            << "\tudp\t" << packet->GetSize() << std::endl);
 
-              receiverDumpFile << std::fixed << std::setprecision(4) << Simulator::Now().ToDouble(ns3::Time::S)
-                               << std::setfill(' ') << std::setw(16) <<  "id " << packetId
-                               << std::setfill(' ') <<  std::setw(16) <<  "udp " << packet->GetSize()
-                               << std::endl;
+              receiverDumpFile.WritePacket (Simulator::Now().ToDouble(ns3::Time::S), packetId, packet->GetSize ());
               double time = Simulator::Now().ToDouble(ns3::Time::S);
-              m_pBuf += packet->GetSize();
+              EvalvidFrameHeader frameHeader;
+              packet->PeekHeader (frameHeader);
+              /* fragments of played frames are not buffered */
+              if (m_frameTracker.AddFragment (frameHeader.GetFrameSequence (), frameHeader.GetFrameNo (),
+                                              frameHeader.GetFrameType (), frameHeader.GetFragmentCount (),
+                                              packet->GetSize (), frameHeader.GetFrameInterval ())) {
+                m_pBuf += packet->GetSize();
+              }
               m_data += packet->GetSize();
               m_oneSdata += packet->GetSize();
               /* interruption finish */
@@ -211,33 +550,58 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                              << "\tInterruption frequency: " << m_interruptCnt
                              << "\tsum of interruption time: " << m_interrupDuration << std::endl);
                 m_interruptFlag = 0;
+                m_qoe.StallEnd (time);
+                m_playoutEvent = Simulator::Schedule (Seconds (GetPlayoutPeriod ()), &EvalvidClient::PlayFrame, this);
+              }
+              /* overflow happens, calculate the overflow */
+              if (m_pBuf > m_maxPBuf) {
+                if (0 == m_overflowFlag) {
+                  m_overflowTime = time;
+                  m_overflowCnt ++;
+                  m_overflowFlag = 1;
+                  m_qoe.OverflowStart (time);
+                  NS_LOG_DEBUG(">> Overflow happens,"
+                     << "\ttime: " << time
+                     << "\toverflow frequency: " << m_overflowCnt << std::endl);
+                }
+                m_pBuf = m_maxPBuf; /*discard the packets */
               }
               if(m_time < 0) {
                   m_time = time;
                   m_lastTime = time;
-                  m_staTime = time;
                   m_detechTime = time;
+                  /* the playout starts with the first packet */
+                  m_playoutEvent = Simulator::Schedule (Seconds (GetPlayoutPeriod ()), &EvalvidClient::PlayFrame, this);
+                  m_qoe.Start (time);
+                  m_qoeEvent = Simulator::Schedule (Seconds (m_qoeWindow), &EvalvidClient::EndQoeWindow, this);
               }
-                  uint32_t frameId;
-                  uint32_t Uid;
-                  uint32_t frameNo;
-                  string frameType;
-                  uint32_t frameSize;
-                  m_revVideoTypeFileName = "videoType1";
-                  ifstream revVideoTypeFile(m_revVideoTypeFileName.c_str(), ios::in);
-                  if (revVideoTypeFile.fail())
-                    {
-                      NS_FATAL_ERROR(">> EvalvidServer: Error while opening receive video trace file: " << m_revVideoTypeFileName.c_str());
-                      return;
-                  }
-                  while (revVideoTypeFile >> frameId >> Uid >> frameNo >> frameType >> frameSize)
+                  m_frameType = EvalvidFrameTag::GetFrameTypeString (frameHeader.GetFrameType ());
+                  m_frameSize = frameHeader.GetFrameSize ();
+                  m_frameId = packetId;
+                  m_frameNo = frameHeader.GetFrameNo ();
+                  double bitrate = frameHeader.GetChunkBitrate ();
+                  uint32_t currentFrame = frameHeader.GetChunkStartFrame ();
+                  uint32_t chunkHeadSize = frameHeader.GetChunkHeadSize ();
+                  if (m_legacyFileSignalling)
                     {
-                      if(packetId == frameId) {
-                          m_frameType = frameType;
-                          m_frameSize = frameSize;
-                          m_frameId = frameId;
-                          m_frameNo = frameNo;
-                      }
+                      /* read the server's videoType1 and bitRate outputs incrementally */
+                      m_videoTypeReader.Poll ();
+                      const EvalvidPacketInfo *info = m_legacyRegistry.LookupByPacketId (packetId);
+                      if (info != 0)
+                        {
+                          m_frameType = info->frameType;
+                          m_frameSize = info->frameSize;
+                          m_frameNo = info->frameId;
+                        }
+                      if (m_bitRateReader.Poll () > 0)
+                        {
+                          istringstream line (m_bitRateReader.GetLastLine ());
+                          line >> m_legacyBitrate >> m_legacyChunkStartFrame;
+                        }
+                      bitrate = m_legacyBitrate;
+                      currentFrame = m_legacyChunkStartFrame;
+                      const EvalvidPacketInfo *head = m_legacyRegistry.LookupByFrameId (currentFrame + 1);
+                      chunkHeadSize = head != 0 ? head->frameSize : 0;
                     }
                 NS_LOG_DEBUG(">> Current frame No is " << m_frameNo
                              << "\tLast frame No is " << m_oldFrameNo << std::endl);
@@ -245,51 +609,46 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                   m_encoderSize = 0;
                 }
                 m_encoderSize += packet->GetSize();
-                m_staPkt ++; // stat packet number in a bitrate
                 m_intervalNum ++; //stat packet number in a interval
-                double bitrate = 0.0;
-                uint32_t currentFrame;
-                string fileName;
-                m_bitRateFileName = "bitRate";
-                ifstream bitRateFile(m_bitRateFileName.c_str(), ios::in);
-                if (bitRateFile.fail())
-                {
-                        NS_FATAL_ERROR(">> EvalvidServer: Error while opening receive bit rate file: " << m_bitRateFileName.c_str());
-                        return;
-                }
-                while (bitRateFile >> bitrate >> currentFrame >> fileName)
-                {
-                }
                 if(m_bitrate != bitrate) {
                         /* bitrate changed */
                         //m_b = m_bitrate * 0.1 * 1024/8/m_avgPktSize; // cal b, original method
                         NS_LOG_DEBUG(">> The threshold of playback b is: " << m_b
                                         << "\tbitrate: " << bitrate << std::endl);    
-                        m_staFlag = 0;    
-                        m_iter = 0;    
-                        m_objf = 1e10;
+                        m_arrivalStats.Clear ();
                 }
 
                 if (currentFrame != m_lastFrame) {
                         N = currentFrame - m_lastFrame; // N frame in a chunk
                         m_lastFrame = currentFrame;
+                        m_estimator->NotifyChunk ();
                         m_flag = 0; // mean a new chunk
+                        SendStatus ();
                 }
                 f = m_frameNo - currentFrame;
                 m_bitrate = bitrate; // current chunk bitrate
+                m_qoe.SetBitrate (time, m_bitrate);
               if (time - m_time >= 0.2){
                         NS_LOG_DEBUG(">> Current time is " << time
                              << "\tLast time " << m_time << std::endl);
-                        m_thoughout = 8*m_data/(1024*(time - m_time));
-                        NS_LOG_DEBUG(">> Thoughput in this tao is " << m_thoughout
+                        double sample = 8*m_data/(1024*(time - m_time));
+                        m_estimator->AddSample (sample, time - m_time);
+                        m_thoughout = m_estimator->GetEstimate ();
+                        NS_LOG_DEBUG(">> Thoughput in this tao is " << sample
+                             << "\testimate: " << m_thoughout
                              << "\tData in this tao: " << m_data << std::endl);
                         m_data = 0;
-                        m_sumThoughout += m_thoughout;
+                        m_sumThoughout += sample;
                         m_count++;
-                        if (0 == m_staFlag) {
-                          m_pktNum.push_back(m_intervalNum);
-                          NS_LOG_DEBUG(">> size: " << m_pktNum.size () << "\t" << m_intervalNum);
-                          m_intervalNum = 0;
+                        m_arrivalStats.Add (m_intervalNum);
+                        m_intervalNum = 0;
+                        /* calculate the threshold b */
+                        if (m_arrivalStats.IsFull () && m_arrivalStats.GetMean () > 0) {
+                          m_lamda = m_arrivalStats.GetMean ();
+                          m_va = m_arrivalStats.GetVariance () / (m_lamda*m_lamda*m_lamda);
+                          NS_LOG_DEBUG(">> mean : " << m_lamda
+                             << "\tvariance " << m_arrivalStats.GetVariance () << std::endl);
+                          UpdateThreshold ();
                         }
                         /* Decision algorithm of thoughput degradation */
                         if (m_thoughout < m_bitrate && m_flag == 0) {
@@ -305,14 +664,7 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                              << "\tthoughput: " << m_thoughout << std::endl);
                           m_flag = 2;
                           k = m_frameNo; // 2nd feedback is received at frame k
-                          ifstream revVideoTypeFile(m_revVideoTypeFileName.c_str(), ios::in);
-                          while (revVideoTypeFile >> frameId >> Uid >> frameNo >> frameType >> frameSize)
-                          {
-                              if(frameNo == (currentFrame + 1)) {
-                                  X = frameSize*1.0/2;
-                                  break;
-                              }
-                          }
+                          X = chunkHeadSize*1.0/2;
                           m_encoderSize -= packet->GetSize();
                           NS_LOG_DEBUG(">> CurrentFrame: " << currentFrame
                              << "\thalf of the head size of the chunk: " << X
@@ -321,62 +673,27 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                         }
                         m_time = time;
               }
-                /* calculate the threshold b */
-                if (m_count > 0 && m_count%25 == 0 && 0 == m_staFlag && (time - m_staTime) > 1){
-                        double lamda;
-                        NS_LOG_DEBUG(">> m_staPkt/(time - m_staTime): " << m_staPkt
-                             << "\ttime - m_staTime " << (time - m_staTime) << std::endl);
-                        uint32_t n = m_pktNum.size ();
-                        double v = 0;
-                        lamda =  m_staPkt/n;
-                        /*uint32_t a;
-                        while (0 < m_pktNum.size ())
-                        {
-                           a = *(m_pktNum.begin ());
-                           NS_LOG_DEBUG(">> m_pktNum =  " << a);
-                           v += (a*a - lamda*lamda);
-                           m_pktNum.erase(m_pktNum.begin ());
-                        }
-                        v/=n;*/
-                        NS_LOG_DEBUG(">> mean : " << lamda
-                             << "\tvariance " << v << std::endl);
-                        /*uint32_t i;
-                        for (i = 5; i <= 100; i++) {
-                          if (1 == m_iter)
-                                break;
-                          constraint (i, lamda, 0.05);
-                        }
-                        if (1 == m_iter) {
-                          NS_LOG_DEBUG("calculate threshold b = " << m_b);
-                        }*/
-                        m_staPkt = 0;
-                        m_staTime = time;
-                        m_staFlag = 1;
-                }
                 /* Decision of bitrate shift */
                 if (m_flag == 2 && m_oldFrameNo != m_frameNo) {
                   if(m_encoderSize > X){
                      m_flag = 3; // break for-loop
-                     m_videoRateFile  << m_thoughout << std::endl; 
+                     SendFeedback (m_thoughout);
                      NS_LOG_DEBUG("conduct bitrate shift 1: f = " << f);
                   }
                   if (f - k > 5 || f == N) {
                      m_flag = 3; // break for-loop
-                     m_videoRateFile  << m_thoughout << std::endl; 
+                     SendFeedback (m_thoughout);
                      NS_LOG_DEBUG("conduct bitrate shift 2: f = " << f);
                   }
                 } else if (m_flag == 3 && m_thoughout > m_bitrate && m_oldFrameNo != m_frameNo) {
-                     m_videoRateFile  << m_thoughout * 1 << std::endl; 
+                     SendFeedback (m_thoughout * 1);
                      m_flag = 4; // break for-loop
                 }
-              /* playback interruption or overflow happens, time is 0.1s */
+              /* thoughput output, time is 0.1s */
               if (time - m_lastTime >= 0.1){
                 m_detechCnt++;
                 if(0 == m_detechCnt % 10) {
-                m_thoughoutFile << std::fixed << std::setprecision(4) << time
-                                << std::setfill(' ') << std::setw(16) << 8*m_oneSdata/(1024*(time - m_detechTime))
-                                << std::setfill(' ') << std::setw(16) << m_bitrate
-                                << std::endl; 
+                m_thoughoutFile.WriteThroughput (time, 8*m_oneSdata/(1024*(time - m_detechTime)), m_bitrate);
                 /* m_oneSdata is used for calculate thoughput in 1s */
                 NS_LOG_DEBUG(">> One second data: " << 8*m_oneSdata/1024
                              << "\ttime interval: " << (time - m_detechTime) << std::endl);
@@ -384,44 +701,10 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
                 m_detechTime = time;
                 }
 
-                /* playback interruption happens, calculate the playback interruption */
-                if ( m_pBuf < m_b*m_avgPktSize && 0 == m_interruptFlag) {
-                    m_interrupTime = time;
-                    NS_LOG_DEBUG(">> Interruption happens, bitrate: " << m_bitrate
-                             << "\ttime: " << m_interrupTime << std::endl);
-                    m_interruptCnt ++;
-                    m_interruptFlag = 1;
-                } else if (m_pBuf >= m_b*m_avgPktSize && 0 == m_interruptFlag) { /* no interruption, playback */
-                     m_pBuf -= m_bitrate * (time - m_lastTime) * 1024/8;
-                     NS_LOG_DEBUG(">> Packets being served at mean rate is: " << m_bitrate * (time - m_lastTime) * 1024/8/1362 
-                                        << "\tbitrate: " << bitrate << std::endl); 
-                }
-                
-                NS_LOG_DEBUG(">> After playback, current buffer is: " << m_pBuf
-                                     << "\tMax buffer size: " << m_maxPBuf << std::endl);  
-
-                /* overflow happens, calculate the overflow */
-                NS_LOG_DEBUG(">> Current buffer is: " << m_pBuf
-                            << "\tMax buffer size: " << m_maxPBuf << std::endl);
-                    if (m_pBuf > m_maxPBuf /*&& 0 == m_overflowFlag*/) {
-                        NS_LOG_DEBUG(">> Overflow happens,"
-                           << "\ttime: " << time << std::endl);
-                        m_overflowTime = time;
-                        m_overflowCnt ++;
-                        m_overflowFlag = 1;
-                        NS_LOG_DEBUG(">> Packets are discarded: " << (m_pBuf - m_maxPBuf) 
-                           << "\toverflow frequency: " << m_overflowCnt << std::endl);
-                        m_pBuf = m_maxPBuf; /*discard the packets */
-                    } 
-      
                 m_lastTime = time;
-                // double mos = calO_41 (m_bitrate, m_interrupDuration/m_interruptCnt, m_interruptCnt);
-                // NS_LOG_DEBUG("MOS = " << calO_41 (m_bitrate, m_interrupDuration/m_interruptCnt, m_interruptCnt));
-                NS_LOG_DEBUG("MOS1 = " << calO_41 (1397, 0, 0, 0, 0));
-                NS_LOG_DEBUG("MOS2 = " << calO_41 (1397, 0.707, 1, 0.052, 2));
-                NS_LOG_DEBUG("MOS3 = " << calO_41 (1287, 0, 0, 0, 0));
               }
               m_oldFrameNo = m_frameNo;
+              m_legacyRegistry.Acknowledge (packetId);
               NS_LOG_DEBUG(">> Average thoughout = " << m_sumThoughout/m_count
                              << "\tSum thoughout: " << m_sumThoughout
                              << "\tCount: " << m_count << std::endl);
@@ -430,142 +713,40 @@ EvalvidClient::HandleRead (Ptr<Socket> socket)
     }
 }
 
-/* Model output O.23 */
-double
-EvalvidClient::calO_23 (double v_br)
-{
-  double v_mosc;
-  double v_dc;
-  double v_abif = 46000; // average number of bytes per I-frame
-  double v_nbr = (v_br * 8 * 30)/(1000 * 30); // Eq. 6-31
-  double v_ccf = sqrt(v_br/(v_abif * 15.0)) > 1.10 ? 1.10 : sqrt(v_br/(v_abif * 15.0)); // Eq. 6-32
-  v_dc = 4/(1 + pow(v_nbr/(104.0*v_ccf + 1.0),(0.01*v_ccf + 1.1))); // Eq. 6-40
-  v_mosc = (5 - v_dc)*(1 + 3.4*v_ccf - 0.969*v_ccf*log(1000/30)); // Eq.6-38
-  return calO_32 (v_mosc);
-}
-
-/* Model output O.32 */
-double
-EvalvidClient::calO_32 (double o23)
-{
-  double av_mosc;
-  av_mosc = o23; //0.7977*o23 + 0.02472*o23; because no audio
-  return av_mosc;
-}
-
-/* Model output O.24 */
-double
-EvalvidClient::calO_24 (double L, uint32_t N)
+/* buffer management */
+void
+EvalvidClient::UpdateThreshold (void)
 {
-  double pBufInd;
-  double tmpStall1 = 1.66 - 1.72*(pow(2.718, (-0.04*L - 0.36)*N)); // III-1
-  double tmpStall2 = tmpStall1 > 4 ? 4 : tmpStall1; // min
-  double degStall = tmpStall2 > 0 ? tmpStall2 : 0; // max
-  double degT0 = 0; // III-3
-  double tmpPb = (degStall + degT0) < 4 ? (degStall + degT0) : 4; // III-4
-  pBufInd = 5 - (tmpPb > 0 ? tmpPb : 0);
-  return pBufInd;
+  if (!m_adaptiveThreshold)
+    {
+      return;
+    }
+  double b = m_thresholdTable.IsEmpty ()
+    ? m_bufferThreshold.Optimize (m_lamda, m_va, 5, 100)
+    : m_thresholdTable.Lookup (m_lamda, m_va);
+  if (b > 0)
+    {
+      m_b = b;
+      NS_LOG_DEBUG("calculate threshold b = " << m_b);
+    }
 }
 
-/* Model output O.25 */
 double
-EvalvidClient::calO_25 (double T, uint32_t M)
+EvalvidClient::phi (double x)
 {
-  double pBufInd;
-  double tmp1 = 1.66 - 1.72*(pow(2.718, (-0.04*T - 0.36)*M)); // III-1
-  double tmp2 = tmp1 > 4 ? 4 : tmp1; // min
-  double degOverflow = tmp2 > 0 ? tmp2 : 0; // max
-  double tmpPb = degOverflow < 4 ? degOverflow : 4; // III-4
-  pBufInd = 5 - (tmpPb > 0 ? tmpPb : 0);
-  return pBufInd;
+  return EvalvidNormalCdf (x);
 }
 
-/* Model output O.41 */
 double
-EvalvidClient::calO_41 (double v_br, double L, uint32_t N, double T, uint32_t M)
+EvalvidClient::constraint (double b, double lamda, double va)
 {
-  double a1 = 0.4175;
-  double a2 = 0.4175;
-  double a3 = 0.0247;
-  double a4 = 0.1403;
-  double o32 = calO_23 (v_br);
-  double o24 = a1*calO_24 (L, N) + a2*calO_25 (T, M) + a3*calO_24 (L, N)*calO_25 (T, M) + a4;
-  double tmp = (o32 - 5 + o24) < 5 ? (o32 - 5 + o24) : 5;
-  double Qms = tmp > 1 ? tmp : 1;
-  return Qms;
+  return m_bufferThreshold.GetConstraint (b, lamda, va);
 }
 
-/**/
-double
-EvalvidClient::expf(double y)
-{
-  return exp(-y*y/2);
-}
 double
-EvalvidClient::phi(double x)
+EvalvidClient::objfunc (double b, double lamda, double va)
 {
-  double y;
-  double s = 0.0;
-  double delta = 0.5;
-  double inf = -1e6;
-  for(y = inf; y <= x; y += delta) {
-    s += expf(y)*delta;
-  }
-  return s;
-}
-double 
-EvalvidClient::constraint (double b, double lamda, double va) {
-  double t = 10.0; //15
-  //double lamda = 50;
-  //double va = 0.05;
-  double beta;
-  double alpha;
-  double f;
-  beta = lamda;
-  alpha = lamda*lamda*lamda*va;
-  double c = phi((b-beta*t)/sqrt(alpha*t)) + exp(2*beta*b/alpha)*phi(-(b+beta*t)/sqrt(alpha*t)) - 0.09;
-  NS_LOG_DEBUG("Charging probability before = " << c);
-  if (c <= 0) {
-    f = objfunc(b, lamda, va);
-    NS_LOG_DEBUG("Charging probability = " << c
-        << "\tb = " << b
-        << "\tmin object: " << f << std::endl);
-    if (m_objf <= f) {
-      m_iter = 1; // last object function value is smaller, stop
-      m_b = b - 1; // threshold b changed
-    }
-    m_objf = f;
-  } else { // current object function value is > 0
-    if (m_c < 0) {
-      m_iter = 1; // stop
-      m_b = b - 1; // threshold b changed
-    } else if (m_c > 0) {
-      m_iter = 1; // stop
-    }
-  }
-  m_c = c;
-  return c;
-}
-double
-EvalvidClient::objfunc (double b, double lamda, double va) {
-  double u = 60;
-  double vs = 0.05;
-  uint32_t N = m_maxPBuf/m_avgPktSize; // 5000, 10000
-  uint32_t S = 100;
-
-  double p1 = 50;
-  double p2 = 0.05;
-  double w1 = 0.1;
-  double vd = 1;
-  double beta = lamda - u;
-  double alpha = lamda*lamda*lamda*va + u*u*u*vs;
-  double r = 2*beta/alpha;
-  double E_D = b/lamda;
-  double V_D = b*va;
-  double L = 1/((-(1-exp(-r)*u*u*b/(lamda*beta*(1-exp(-r*b)*exp(r*(N-1)))))) + lamda/beta);
-  double C = 1/(-u/beta + lamda*lamda*exp(r*(N-1))*(1-exp(-r*b))/(beta*b*u*(1-exp(-r))));
-  double f = p1*L + (p2*C*S)/E_D + w1*(E_D + vd*V_D);
-  return f;
+  return m_bufferThreshold.GetObjective (b, lamda, va);
 }
 
 } // Namespace ns3
@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/seq-ts-header.h"
+#include "ns3/traced-callback.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -39,6 +40,14 @@
 #include <fstream>
 #include <iomanip>
 #include "ns3/qos-tag.h"
+#include "evalvid-frame-registry.h"
+#include "evalvid-tail-reader.h"
+#include "evalvid-dump-writer.h"
+#include "evalvid-buffer-threshold.h"
+#include "evalvid-window-statistics.h"
+#include "evalvid-frame-tracker.h"
+#include "evalvid-throughput-estimator.h"
+#include "evalvid-qoe.h"
 
 using std::ifstream;
 using std::ofstream;
@@ -53,6 +62,7 @@ namespace ns3 {
 
 class Socket;
 class Packet;
+class LteUeRrc;
 
 /**
  * \ingroup evalvid
@@ -80,6 +90,11 @@ public:
    */
   void SetRemote (Ipv4Address ip, uint16_t port);
 
+  /// \returns the ITU-T P.1201 MOS of the session so far
+  double GetSessionMos (void) const;
+  /// \returns the P.1201 inputs of the session so far, e.g. for an EvalvidQoeBatch
+  EvalvidQoeInputs GetQoeInputs (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -89,27 +104,58 @@ private:
   virtual void StopApplication (void);
 
   void Send (void);
+  /// \returns the suffix of the files named after the ClientId, empty for id 0
+  string GetFileSuffix (void) const;
+  /// \returns the RRC of the LTE UE device of the node, or 0 if it has none.
+  Ptr<LteUeRrc> GetUeRrc (void) const;
+  /**
+   * \brief send an in-band rate feedback message to the server
+   * \param rate the bitrate requested from the server (kbit/s)
+   */
+  void SendFeedback (double rate);
+  /**
+   * \brief report the throughput and playback buffer to the server
+   *
+   * Sent at every new chunk, so that buffer-based rules on the server see
+   * a current buffer level; the requested rate is the last one fed back.
+   */
+  void SendStatus (void);
+  /// Parse a line of the videoType1 file in legacy file signalling mode.
+  void HandleVideoTypeLine (const std::string &line);
   void HandleRead (Ptr<Socket> socket);
-  /* ITU-T P.1201 */
-  double calO_23 (double v_br);
-  double calO_32 (double o23);
-  double calO_24 (double L, uint32_t N);
-  double calO_25 (double T, uint32_t M);
-  double calO_41 (double v_br, double L, uint32_t N, double T, uint32_t M);
+  /**
+   * \brief play one frame out of the playback buffer
+   *
+   * Drains the bytes received for the frame and schedules the next one
+   * after its interval in the trace. A frame finding the buffer below the
+   * threshold starts an interruption and the events stop until packets
+   * refill the buffer.
+   */
+  void PlayFrame (void);
+  /// \returns the interval of the last played frame, 1/PlayoutFrameRate before it is known (s)
+  double GetPlayoutPeriod (void) const;
+  /// Invoked by the frame tracker for every played frame; counts it in the QoE timeline.
+  void HandleFramePlayed (uint32_t frameNo, EvalvidFrameTag::FrameType frameType,
+                          EvalvidFrameTracker::FrameStatus status);
+  /// Close a window of the ITU-T P.1201 MOS time series; scheduled every QoeWindow.
+  void EndQoeWindow (void);
   /* buffer management */
   double constraint (double b, double lamda, double va);
-  double expf (double x);
   double phi (double a);
   double objfunc (double b, double lamda, double va);
+  /// Set m_b from m_lamda and m_va, by table lookup if a table is loaded.
+  void UpdateThreshold (void);
 
-  ofstream    receiverDumpFile;
+  EvalvidDumpWriter receiverDumpFile;
   string      receiverDumpFileName;
+  bool        m_binaryDump;
   Ptr<Socket> m_socket;
   Ipv4Address m_peerAddress;
   uint16_t    m_peerPort;
+  uint16_t    m_bearerCellId;
+  uint16_t    m_bearerRnti;
+  uint8_t     m_bearerLcid;
   EventId     m_sendEvent;
-  string      m_bitRateFileName;
-  ofstream    m_bitRateFile;
   double      m_time;
   double      m_lastTime;
   double      m_interrupTime;
@@ -123,7 +169,6 @@ private:
   uint16_t    m_count;
   uint16_t    m_flag;
   double      m_bitrate;
-  string      m_revVideoTypeFileName;
   string      m_frameType;
   uint32_t    m_frameSize;
   uint32_t    m_frameId;
@@ -136,30 +181,50 @@ private:
   double      m_encoderSize;
   uint32_t    m_oldFrameNo;
   string      m_videoRateFileName;
-  ofstream    m_videoRateFile;
+  uint32_t    m_clientId;
+  EvalvidDumpWriter m_videoRateFile;
   string      m_thoughoutFileName;
-  ofstream    m_thoughoutFile;
-  double      m_thoughout;
+  EvalvidDumpWriter m_thoughoutFile;
+  bool        m_asyncOutput;
+  double      m_thoughout; // estimated throughput
+  double      m_requestedRate; // last rate fed back to the server
+  TypeId      m_estimatorType;
+  Ptr<EvalvidThroughputEstimator> m_estimator;
   double      m_pBuf; // playback buffer
   double      m_maxPBuf;
   double      m_overflowTime;
   uint16_t    m_overflowCnt;
   uint16_t    m_overflowFlag;
   double      m_overflowDuration;
+  double      m_playoutFrameRate;
+  double      m_frameInterval; // interval of the last played frame (s)
+  EventId     m_playoutEvent;
+  EvalvidFrameTracker m_frameTracker;
+  uint32_t    m_frameTrackerCapacity;
+  TracedCallback<uint32_t, uint8_t, uint8_t> m_framePlayedTrace;
+  EvalvidQoeTimeline m_qoe;
+  double      m_qoeWindow;
+  EventId     m_qoeEvent;
+  TracedCallback<double> m_windowMosTrace;
   double      m_b; // threshold
-  double      m_iter;
-  double      m_objf;
-  double      m_c;
-  double      m_staTime;
-  uint32_t    m_staPkt;
-  uint32_t    m_staFlag;
-  std::vector < uint32_t > m_pktNum; 
+  bool        m_adaptiveThreshold;
+  EvalvidBufferThreshold m_bufferThreshold;
+  string      m_thresholdTableFileName;
+  EvalvidThresholdTable m_thresholdTable;
+  EvalvidWindowStatistics m_arrivalStats; // packets per interval at the current bitrate
+  uint32_t    m_statisticsWindow;
   uint32_t    m_intervalNum;
   double      m_lamda;
   double      m_va;
   uint32_t    m_avgPktSize;
   uint32_t    m_detechCnt;
   double      m_detechTime;
+  bool        m_legacyFileSignalling;
+  EvalvidTailReader m_videoTypeReader;
+  EvalvidTailReader m_bitRateReader;
+  EvalvidFrameRegistry m_legacyRegistry; // packets parsed from videoType1
+  double      m_legacyBitrate;
+  uint32_t    m_legacyChunkStartFrame;
 };
 
 } // namespace ns3
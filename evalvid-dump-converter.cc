@@ -0,0 +1,55 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/evalvid-dump-writer.h"
+#include "ns3/evalvid-file-converter.h"
+
+using namespace ns3;
+
+/**
+ * Converts the binary dumps written with the BinaryDump attribute of
+ * EvalvidServer and EvalvidClient to the Evalvid sd/rd (and videoType1)
+ * text read by etmp4. Each output is written next to its input as
+ * "<input>.txt", unless --output is given for a single input.
+ *
+ *   ./waf --run "evalvid-dump-converter --input=sd_a01,rd_a01"
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidDumpConverter");
+
+static std::string
+GetTextFileName (const std::string &binaryFileName)
+{
+  return binaryFileName + ".txt";
+}
+
+int
+main (int argc, char *argv[])
+{
+  EvalvidFileConversion conversion;
+  conversion.usage = "evalvid-dump-converter --input=dump[,dump...] [--output=file]";
+  conversion.inputHelp = "Comma separated binary dump files";
+  conversion.outputHelp = "Text dump file, when a single input is given";
+  conversion.convert = &EvalvidDumpWriter::ConvertToText;
+  conversion.outputName = &GetTextFileName;
+  return EvalvidRunFileConverter (argc, argv, conversion);
+}
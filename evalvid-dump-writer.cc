@@ -0,0 +1,396 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+#include "evalvid-dump-writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <inttypes.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidDumpWriter");
+
+static_assert (sizeof (EvalvidDumpFileHeader) == 32, "EvalvidDumpFileHeader must stay packed");
+static_assert (sizeof (EvalvidPacketDumpRecord) == 16, "EvalvidPacketDumpRecord must stay packed");
+static_assert (sizeof (EvalvidVideoTypeDumpRecord) == 24, "EvalvidVideoTypeDumpRecord must stay packed");
+
+// Longest text line: the names of the bitRate lines are cut to 256 characters.
+static const size_t MAX_LINE = 320;
+
+EvalvidDumpWriter::EvalvidDumpWriter ()
+  : m_fd (-1),
+    m_binary (false),
+    m_async (false),
+    m_lineFlush (false),
+    m_used (0)
+{
+}
+
+EvalvidDumpWriter::~EvalvidDumpWriter ()
+{
+  Close ();
+}
+
+bool
+EvalvidDumpWriter::Open (const std::string &fileName, Kind kind, bool binary, uint32_t bufferSize, bool async)
+{
+  Close ();
+  NS_ABORT_MSG_IF (binary && kind != PACKET_DUMP && kind != VIDEO_TYPE_DUMP,
+                   "EvalvidDumpWriter: no binary form for " << fileName);
+  m_fd = open (fileName.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0)
+    {
+      return false;
+    }
+  m_fileName = fileName;
+  m_binary = binary;
+  m_async = async;
+  m_lineFlush = bufferSize == 0;
+  m_buffer.resize (std::max<size_t> (bufferSize, MAX_LINE));
+  m_used = 0;
+  if (m_async)
+    {
+      EvalvidOutputThread::Get ()->Start ();
+    }
+
+  if (m_binary)
+    {
+      EvalvidDumpFileHeader header;
+      std::memset (&header, 0, sizeof (header));
+      header.magic = EvalvidDumpFileHeader::MAGIC;
+      header.version = EvalvidDumpFileHeader::VERSION;
+      header.recordSize = kind == PACKET_DUMP ? sizeof (EvalvidPacketDumpRecord) : sizeof (EvalvidVideoTypeDumpRecord);
+      header.kind = kind;
+      Append (&header, sizeof (header));
+    }
+  return true;
+}
+
+bool
+EvalvidDumpWriter::IsOpen (void) const
+{
+  return m_fd >= 0;
+}
+
+void
+EvalvidDumpWriter::WritePacket (double time, uint32_t packetId, uint32_t size)
+{
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = WRITE_PACKET;
+  record.d[0] = time;
+  record.u32[0] = packetId;
+  record.u32[1] = size;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::WriteVideoType (uint32_t packetId, uint64_t uid, uint32_t frameId,
+                                   EvalvidFrameTag::FrameType frameType, uint32_t frameSize)
+{
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = WRITE_VIDEO_TYPE;
+  record.u64 = uid;
+  record.u32[0] = packetId;
+  record.u32[1] = frameId;
+  record.u32[2] = frameSize;
+  record.d[0] = frameType;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::WriteBitRate (double bitrate, uint32_t frameId, const std::string &fileName)
+{
+  std::map<std::string, uint32_t>::const_iterator it = m_nameIndex.find (fileName);
+  if (it == m_nameIndex.end ())
+    {
+      CriticalSection cs (m_namesMutex);
+      it = m_nameIndex.insert (std::make_pair (fileName, m_names.size ())).first;
+      m_names.push_back (fileName);
+    }
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = WRITE_BIT_RATE;
+  record.d[0] = bitrate;
+  record.u32[0] = frameId;
+  record.u32[1] = it->second;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::WriteRate (double rate)
+{
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = WRITE_RATE;
+  record.d[0] = rate;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::WriteThroughput (double time, double throughput, double bitrate)
+{
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = WRITE_THROUGHPUT;
+  record.d[0] = time;
+  record.d[1] = throughput;
+  record.d[2] = bitrate;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::Submit (const EvalvidOutputRecord &record)
+{
+  if (m_fd < 0)
+    {
+      // Closed: a queued record would outlive a writer that no longer drains.
+      return;
+    }
+  if (m_async)
+    {
+      EvalvidOutputThread::Get ()->Push (record);
+    }
+  else
+    {
+      Execute (record);
+    }
+}
+
+void
+EvalvidDumpWriter::Execute (const EvalvidOutputRecord &record)
+{
+  switch (record.op)
+    {
+    case WRITE_PACKET:
+      {
+        EvalvidPacketDumpRecord packet;
+        packet.time = record.d[0];
+        packet.packetId = record.u32[0];
+        packet.size = record.u32[1];
+        if (m_binary)
+          {
+            Append (&packet, sizeof (packet));
+          }
+        else
+          {
+            CommitLine (FormatPacket (ReserveLine (), MAX_LINE, packet));
+          }
+        break;
+      }
+    case WRITE_VIDEO_TYPE:
+      {
+        EvalvidVideoTypeDumpRecord videoType;
+        videoType.uid = record.u64;
+        videoType.packetId = record.u32[0];
+        videoType.frameId = record.u32[1];
+        videoType.frameSize = record.u32[2];
+        videoType.frameType = (uint8_t) record.d[0];
+        std::memset (videoType.reserved, 0, sizeof (videoType.reserved));
+        if (m_binary)
+          {
+            Append (&videoType, sizeof (videoType));
+          }
+        else
+          {
+            CommitLine (FormatVideoType (ReserveLine (), MAX_LINE, videoType));
+          }
+        break;
+      }
+    case WRITE_BIT_RATE:
+      {
+        CriticalSection cs (m_namesMutex);
+        // std::fixed << std::setprecision (4) << bitrate << std::setw (16) << frameId ...
+        CommitLine (snprintf (ReserveLine (), MAX_LINE, "%.4f%16" PRIu32 "%16.256s\n",
+                              record.d[0], record.u32[0], m_names[record.u32[1]].c_str ()));
+        break;
+      }
+    case WRITE_RATE:
+      // Default stream format.
+      CommitLine (snprintf (ReserveLine (), MAX_LINE, "%g\n", record.d[0]));
+      break;
+    case WRITE_THROUGHPUT:
+      CommitLine (snprintf (ReserveLine (), MAX_LINE, "%.4f%16.4f%16.4f\n",
+                            record.d[0], record.d[1], record.d[2]));
+      break;
+    case FLUSH:
+      WriteBuffer ();
+      break;
+    default:
+      NS_FATAL_ERROR (">> EvalvidDumpWriter: Unknown record " << record.op);
+    }
+}
+
+char *
+EvalvidDumpWriter::ReserveLine (void)
+{
+  if (m_buffer.size () - m_used < MAX_LINE)
+    {
+      WriteBuffer ();
+    }
+  return &m_buffer[m_used];
+}
+
+void
+EvalvidDumpWriter::CommitLine (int length)
+{
+  m_used += std::min<size_t> (length, MAX_LINE - 1);
+  if (m_lineFlush)
+    {
+      WriteBuffer ();
+    }
+}
+
+void
+EvalvidDumpWriter::Append (const void *data, size_t size)
+{
+  if (m_buffer.size () - m_used < size)
+    {
+      WriteBuffer ();
+    }
+  std::memcpy (&m_buffer[m_used], data, size);
+  m_used += size;
+  if (m_lineFlush)
+    {
+      WriteBuffer ();
+    }
+}
+
+void
+EvalvidDumpWriter::WriteBuffer (void)
+{
+  if (m_fd < 0)
+    {
+      m_used = 0;
+      return;
+    }
+  size_t written = 0;
+  while (written < m_used)
+    {
+      ssize_t n = write (m_fd, &m_buffer[written], m_used - written);
+      if (n < 0)
+        {
+          NS_FATAL_ERROR (">> EvalvidDumpWriter: Error while writing dump file: " << m_fileName);
+        }
+      written += n;
+    }
+  m_used = 0;
+}
+
+void
+EvalvidDumpWriter::Flush (void)
+{
+  EvalvidOutputRecord record;
+  record.writer = this;
+  record.op = FLUSH;
+  Submit (record);
+}
+
+void
+EvalvidDumpWriter::Close (void)
+{
+  if (m_fd < 0)
+    {
+      return;
+    }
+  if (m_async)
+    {
+      EvalvidOutputThread::Get ()->Drain ();
+    }
+  WriteBuffer ();
+  close (m_fd);
+  m_fd = -1;
+}
+
+int
+EvalvidDumpWriter::FormatPacket (char *line, size_t size, const EvalvidPacketDumpRecord &record)
+{
+  // std::fixed << std::setprecision (4) << time << std::setw (16) << "id " << id ...
+  return snprintf (line, size, "%.4f%16s%" PRIu32 "%16s%" PRIu32 "\n",
+                   record.time, "id ", record.packetId, "udp ", record.size);
+}
+
+int
+EvalvidDumpWriter::FormatVideoType (char *line, size_t size, const EvalvidVideoTypeDumpRecord &record)
+{
+  std::string frameType = EvalvidFrameTag::GetFrameTypeString (static_cast<EvalvidFrameTag::FrameType> (record.frameType));
+  return snprintf (line, size, "%" PRIu32 "%16" PRIu64 "%16" PRIu32 "%16s%16" PRIu32 "\n",
+                   record.packetId, record.uid, record.frameId, frameType.c_str (), record.frameSize);
+}
+
+bool
+EvalvidDumpWriter::ConvertToText (const std::string &binaryFileName, const std::string &textFileName)
+{
+  FILE *in = fopen (binaryFileName.c_str (), "rb");
+  if (in == 0)
+    {
+      return false;
+    }
+  EvalvidDumpFileHeader header;
+  if (fread (&header, sizeof (header), 1, in) != 1
+      || header.magic != EvalvidDumpFileHeader::MAGIC
+      || header.version != EvalvidDumpFileHeader::VERSION
+      || (header.kind == PACKET_DUMP && header.recordSize != sizeof (EvalvidPacketDumpRecord))
+      || (header.kind == VIDEO_TYPE_DUMP && header.recordSize != sizeof (EvalvidVideoTypeDumpRecord))
+      || (header.kind != PACKET_DUMP && header.kind != VIDEO_TYPE_DUMP))
+    {
+      NS_LOG_WARN (">> EvalvidDumpWriter: Not a binary dump: " << binaryFileName);
+      fclose (in);
+      return false;
+    }
+
+  EvalvidDumpWriter out;
+  if (!out.Open (textFileName, static_cast<Kind> (header.kind), false, 1 << 20, false))
+    {
+      fclose (in);
+      return false;
+    }
+  if (header.kind == PACKET_DUMP)
+    {
+      EvalvidPacketDumpRecord record;
+      while (fread (&record, sizeof (record), 1, in) == 1)
+        {
+          out.WritePacket (record.time, record.packetId, record.size);
+        }
+    }
+  else
+    {
+      EvalvidVideoTypeDumpRecord record;
+      while (fread (&record, sizeof (record), 1, in) == 1)
+        {
+          out.WriteVideoType (record.packetId, record.uid, record.frameId,
+                              static_cast<EvalvidFrameTag::FrameType> (record.frameType), record.frameSize);
+        }
+    }
+  bool ok = ferror (in) == 0;
+  fclose (in);
+  out.Close ();
+  return ok;
+}
+
+} // namespace ns3
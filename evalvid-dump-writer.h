@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_DUMP_WRITER_H__
+#define __EVALVID_DUMP_WRITER_H__
+
+#include "ns3/system-mutex.h"
+#include "evalvid-frame-tag.h"
+#include "evalvid-output-thread.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief Header of a binary dump file, followed by records of one kind.
+ *
+ * Like binary traces, binary dumps are written in host byte order.
+ */
+struct EvalvidDumpFileHeader
+{
+  static const uint32_t MAGIC = 0x45564450;  //!< "EVDP"
+  static const uint16_t VERSION = 1;
+
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;  //!< Size of one record of the writer.
+  uint32_t kind;        //!< An EvalvidDumpWriter::Kind.
+  uint32_t reserved[5];
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief One line of an Evalvid sender (sd) or receiver (rd) dump.
+ *
+ * The time is the double the text line is printed from, so that the
+ * converted text is the one the simulation would have written.
+ */
+struct EvalvidPacketDumpRecord
+{
+  double   time;      //!< Seconds.
+  uint32_t packetId;
+  uint32_t size;      //!< UDP payload in bytes.
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief One line of the videoType1 file of EvalvidServer.
+ */
+struct EvalvidVideoTypeDumpRecord
+{
+  uint64_t uid;       //!< Uid of the packet.
+  uint32_t packetId;
+  uint32_t frameId;
+  uint32_t frameSize;
+  uint8_t  frameType; //!< An EvalvidFrameTag::FrameType.
+  uint8_t  reserved[3];
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidDumpWriter
+ * \brief Buffered writer of the output files of EvalvidServer and EvalvidClient.
+ *
+ * Lines, or records in binary mode, are appended to a memory buffer that
+ * is written to the file only when it is full and on Flush or Close, so
+ * the dumps cost no system call per packet. A buffer size of 0 writes every
+ * line at once, for the files another application follows while the
+ * simulation runs. Text lines are formatted with a single snprintf, byte
+ * for byte as the iostream manipulators used to. Binary dumps are turned
+ * into the same text by ConvertToText; only packet and videoType1 dumps
+ * have a binary form.
+ *
+ * An asynchronous writer only packs the arguments of each call into an
+ * EvalvidOutputRecord for the EvalvidOutputThread, which formats and writes
+ * it. Close waits for the records of the writer to be written.
+ */
+class EvalvidDumpWriter
+{
+public:
+  /// Record kinds of a dump file.
+  enum Kind
+  {
+    PACKET_DUMP     = 1,  //!< sd and rd files.
+    VIDEO_TYPE_DUMP = 2,  //!< videoType1 file.
+    BIT_RATE_DUMP   = 3,  //!< bitRate file of EvalvidServer.
+    RATE_DUMP       = 4,  //!< videoRate file of EvalvidClient.
+    THROUGHPUT_DUMP = 5   //!< thoughoutFile of EvalvidClient.
+  };
+
+  /// Operations of an EvalvidOutputRecord.
+  enum Op
+  {
+    WRITE_PACKET     = 0,
+    WRITE_VIDEO_TYPE = 1,
+    WRITE_BIT_RATE   = 2,
+    WRITE_RATE       = 3,
+    WRITE_THROUGHPUT = 4,
+    FLUSH            = 5
+  };
+
+  EvalvidDumpWriter ();
+  ~EvalvidDumpWriter ();
+
+  /**
+   * \brief create or truncate the dump file
+   * \param fileName the dump file
+   * \param kind kind of the records written to it
+   * \param binary write records instead of text lines
+   * \param bufferSize bytes kept in memory before they are written, 0 to write every line
+   * \param async format and write on the EvalvidOutputThread
+   * \returns false if the file cannot be created
+   */
+  bool Open (const std::string &fileName, Kind kind, bool binary, uint32_t bufferSize, bool async);
+  bool IsOpen (void) const;
+
+  /// Append a PACKET_DUMP line.
+  void WritePacket (double time, uint32_t packetId, uint32_t size);
+  /// Append a VIDEO_TYPE_DUMP line.
+  void WriteVideoType (uint32_t packetId, uint64_t uid, uint32_t frameId,
+                       EvalvidFrameTag::FrameType frameType, uint32_t frameSize);
+  /// Append a BIT_RATE_DUMP line.
+  void WriteBitRate (double bitrate, uint32_t frameId, const std::string &fileName);
+  /// Append a RATE_DUMP line.
+  void WriteRate (double rate);
+  /// Append a THROUGHPUT_DUMP line.
+  void WriteThroughput (double time, double throughput, double bitrate);
+
+  /// Write the buffered bytes to the file; asynchronous writers do it after their pending records.
+  void Flush (void);
+  /// Flush and close the file.
+  void Close (void);
+
+  /**
+   * \brief convert a binary dump to the text the simulation writes in text mode
+   * \param binaryFileName the binary dump
+   * \param textFileName the text dump to write
+   * \returns false if the binary dump cannot be read or the text written
+   */
+  static bool ConvertToText (const std::string &binaryFileName, const std::string &textFileName);
+
+private:
+  friend class EvalvidOutputThread;
+
+  EvalvidDumpWriter (const EvalvidDumpWriter &);
+  EvalvidDumpWriter &operator= (const EvalvidDumpWriter &);
+
+  /// Format one line into line, at most size bytes; \returns its length.
+  static int FormatPacket (char *line, size_t size, const EvalvidPacketDumpRecord &record);
+  static int FormatVideoType (char *line, size_t size, const EvalvidVideoTypeDumpRecord &record);
+
+  /// Hand the record to the output thread, or run it if the writer is synchronous.
+  void Submit (const EvalvidOutputRecord &record);
+  /// Format and buffer one record; runs on the output thread for asynchronous writers.
+  void Execute (const EvalvidOutputRecord &record);
+  /// Make room for a line in the buffer.
+  char *ReserveLine (void);
+  /// Account a line of length bytes written by ReserveLine.
+  void CommitLine (int length);
+  void Append (const void *data, size_t size);
+  void WriteBuffer (void);
+
+  std::string m_fileName;
+  int m_fd;
+  bool m_binary;
+  bool m_async;
+  bool m_lineFlush;
+  std::vector<char> m_buffer;
+  size_t m_used;
+  // Names of the bitRate lines: indexed by the simulation, read by the output thread.
+  std::map<std::string, uint32_t> m_nameIndex;
+  std::deque<std::string> m_names;
+  SystemMutex m_namesMutex;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_DUMP_WRITER_H__
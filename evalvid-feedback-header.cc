@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+
+#include "evalvid-feedback-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidFeedbackHeader");
+NS_OBJECT_ENSURE_REGISTERED (EvalvidFeedbackHeader);
+
+TypeId
+EvalvidFeedbackHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidFeedbackHeader")
+    .SetParent<Header> ()
+    .AddConstructor<EvalvidFeedbackHeader> ()
+    ;
+  return tid;
+}
+
+TypeId
+EvalvidFeedbackHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+EvalvidFeedbackHeader::EvalvidFeedbackHeader ()
+  : m_magic (MAGIC),
+    m_requestedBitrate (0),
+    m_throughput (0),
+    m_bufferLevel (0)
+{
+}
+
+uint32_t
+EvalvidFeedbackHeader::GetSerializedSize (void) const
+{
+  return 16;
+}
+
+void
+EvalvidFeedbackHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_magic);
+  i.WriteHtonU32 (m_requestedBitrate);
+  i.WriteHtonU32 (m_throughput);
+  i.WriteHtonU32 (m_bufferLevel);
+}
+
+uint32_t
+EvalvidFeedbackHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_magic = i.ReadNtohU32 ();
+  m_requestedBitrate = i.ReadNtohU32 ();
+  m_throughput = i.ReadNtohU32 ();
+  m_bufferLevel = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+EvalvidFeedbackHeader::Print (std::ostream &os) const
+{
+  os << "(requested=" << GetRequestedBitrate ()
+     << " throughput=" << GetThroughput ()
+     << " buffer=" << m_bufferLevel << ")";
+}
+
+void
+EvalvidFeedbackHeader::SetRequestedBitrate (double bitrate)
+{
+  m_requestedBitrate = (uint32_t) (bitrate * 1000 + 0.5);
+}
+
+double
+EvalvidFeedbackHeader::GetRequestedBitrate (void) const
+{
+  return m_requestedBitrate / 1000.0;
+}
+
+void
+EvalvidFeedbackHeader::SetThroughput (double throughput)
+{
+  m_throughput = (uint32_t) (throughput * 1000 + 0.5);
+}
+
+double
+EvalvidFeedbackHeader::GetThroughput (void) const
+{
+  return m_throughput / 1000.0;
+}
+
+void
+EvalvidFeedbackHeader::SetBufferLevel (uint32_t bufferLevel)
+{
+  m_bufferLevel = bufferLevel;
+}
+
+uint32_t
+EvalvidFeedbackHeader::GetBufferLevel (void) const
+{
+  return m_bufferLevel;
+}
+
+bool
+EvalvidFeedbackHeader::IsFeedback (Ptr<const Packet> packet)
+{
+  EvalvidFeedbackHeader header;
+  if (packet->GetSize () < header.GetSerializedSize ())
+    {
+      return false;
+    }
+  packet->PeekHeader (header);
+  return header.m_magic == MAGIC;
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_FEEDBACK_HEADER_H__
+#define __EVALVID_FEEDBACK_HEADER_H__
+
+#include "ns3/header.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidFeedbackHeader
+ * \brief Rate feedback sent by EvalvidClient to EvalvidServer.
+ *
+ * The client sends it when it requests a new rate, and at every new chunk
+ * with its last requested rate, to report its throughput and buffer level.
+ * The message travels over the socket the client already uses for the
+ * streaming request. It starts with a magic number, so that the server can
+ * tell it apart from the streaming request. Rates are in
+ * kbit/s as measured by the client and are carried with a resolution of
+ * 0.001 kbit/s.
+ */
+class EvalvidFeedbackHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  EvalvidFeedbackHeader ();
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  /// \param bitrate bitrate the client asks the server to stream at (kbit/s)
+  void SetRequestedBitrate (double bitrate);
+  double GetRequestedBitrate (void) const;
+  /// \param throughput throughput measured by the client (kbit/s)
+  void SetThroughput (double throughput);
+  double GetThroughput (void) const;
+  /// \param bufferLevel playback buffer occupancy of the client (bytes)
+  void SetBufferLevel (uint32_t bufferLevel);
+  uint32_t GetBufferLevel (void) const;
+
+  /**
+   * \param packet a packet received by EvalvidServer
+   * \returns true if the packet starts with an EvalvidFeedbackHeader
+   */
+  static bool IsFeedback (Ptr<const Packet> packet);
+
+private:
+  static const uint32_t MAGIC = 0x45564642; // "EVFB"
+
+  uint32_t m_magic;
+  uint32_t m_requestedBitrate; // 0.001 kbit/s
+  uint32_t m_throughput;       // 0.001 kbit/s
+  uint32_t m_bufferLevel;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_FEEDBACK_HEADER_H__
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "ns3/command-line.h"
+
+#include "evalvid-file-converter.h"
+
+#include <iostream>
+
+namespace ns3 {
+
+int
+EvalvidRunFileConverter (int argc, char *argv[], const EvalvidFileConversion &conversion)
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", conversion.inputHelp, input);
+  cmd.AddValue ("output", conversion.outputHelp, output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Usage: " << conversion.usage << std::endl;
+      return 1;
+    }
+
+  bool single = input.find (',') == std::string::npos;
+  int failures = 0;
+  std::string::size_type begin = 0;
+  while (begin <= input.size ())
+    {
+      std::string::size_type end = input.find (',', begin);
+      if (end == std::string::npos)
+        {
+          end = input.size ();
+        }
+      std::string inputFileName = input.substr (begin, end - begin);
+      begin = end + 1;
+      if (inputFileName.empty ())
+        {
+          continue;
+        }
+
+      std::string outputFileName = single && !output.empty ()
+        ? output : conversion.outputName (inputFileName);
+      if (conversion.convert (inputFileName, outputFileName))
+        {
+          std::cout << inputFileName << " -> " << outputFileName << std::endl;
+        }
+      else
+        {
+          std::cerr << "Error while converting " << inputFileName << std::endl;
+          failures++;
+        }
+    }
+  return failures == 0 ? 0 : 1;
+}
+
+} // namespace ns3
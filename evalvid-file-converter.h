@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_FILE_CONVERTER_H__
+#define __EVALVID_FILE_CONVERTER_H__
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief One kind of file conversion, run by EvalvidRunFileConverter.
+ */
+struct EvalvidFileConversion
+{
+  /// \returns false if inputFileName cannot be converted to outputFileName
+  typedef bool (*ConvertFunction) (const std::string &inputFileName, const std::string &outputFileName);
+  /// \returns the default output file name of inputFileName
+  typedef std::string (*OutputNameFunction) (const std::string &inputFileName);
+
+  const char *usage;       //!< Printed when no input is given.
+  const char *inputHelp;   //!< Help of --input.
+  const char *outputHelp;  //!< Help of --output.
+  ConvertFunction convert;
+  OutputNameFunction outputName;
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief main of the Evalvid file conversion programs
+ *
+ * Converts every file of the comma separated --input, each to its default
+ * output name or, for a single input, to --output if it is given, and
+ * reports every conversion.
+ *
+ * \param argc argument count of main
+ * \param argv arguments of main
+ * \param conversion the conversion to run
+ * \returns the exit status: 0 if every input was converted
+ */
+int EvalvidRunFileConverter (int argc, char *argv[], const EvalvidFileConversion &conversion);
+
+} // namespace ns3
+
+#endif // __EVALVID_FILE_CONVERTER_H__
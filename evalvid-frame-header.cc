@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "evalvid-frame-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (EvalvidFrameHeader);
+
+TypeId
+EvalvidFrameHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidFrameHeader")
+    .SetParent<Header> ()
+    .AddConstructor<EvalvidFrameHeader> ()
+    ;
+  return tid;
+}
+
+TypeId
+EvalvidFrameHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+EvalvidFrameHeader::EvalvidFrameHeader ()
+  : m_frameNo (0),
+    m_frameSeq (0),
+    m_frameType (EvalvidFrameTag::UNKNOWN_FRAME),
+    m_frameSize (0),
+    m_fragmentCount (0),
+    m_frameInterval (0),
+    m_chunkId (0),
+    m_chunkStartFrame (0),
+    m_chunkHeadSize (0),
+    m_chunkBitrate (0)
+{
+}
+
+uint32_t
+EvalvidFrameHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 1 + 4 + 2 + 4 + 4 + 4 + 4 + 4;
+}
+
+void
+EvalvidFrameHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_frameNo);
+  i.WriteHtonU32 (m_frameSeq);
+  i.WriteU8 (m_frameType);
+  i.WriteHtonU32 (m_frameSize);
+  i.WriteHtonU16 (m_fragmentCount);
+  i.WriteHtonU32 (m_frameInterval);
+  i.WriteHtonU32 (m_chunkId);
+  i.WriteHtonU32 (m_chunkStartFrame);
+  i.WriteHtonU32 (m_chunkHeadSize);
+  i.WriteHtonU32 (m_chunkBitrate);
+}
+
+uint32_t
+EvalvidFrameHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_frameNo = i.ReadNtohU32 ();
+  m_frameSeq = i.ReadNtohU32 ();
+  m_frameType = i.ReadU8 ();
+  m_frameSize = i.ReadNtohU32 ();
+  m_fragmentCount = i.ReadNtohU16 ();
+  m_frameInterval = i.ReadNtohU32 ();
+  m_chunkId = i.ReadNtohU32 ();
+  m_chunkStartFrame = i.ReadNtohU32 ();
+  m_chunkHeadSize = i.ReadNtohU32 ();
+  m_chunkBitrate = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+EvalvidFrameHeader::Print (std::ostream &os) const
+{
+  os << "(frame=" << m_frameNo
+     << " seq=" << m_frameSeq
+     << " type=" << EvalvidFrameTag::GetFrameTypeString (GetFrameType ())
+     << " size=" << m_frameSize
+     << " fragments=" << m_fragmentCount
+     << " interval=" << m_frameInterval
+     << " chunk=" << m_chunkId
+     << " chunkStart=" << m_chunkStartFrame
+     << " bitrate=" << GetChunkBitrate () << ")";
+}
+
+void
+EvalvidFrameHeader::SetFrameNo (uint32_t frameNo)
+{
+  m_frameNo = frameNo;
+}
+
+uint32_t
+EvalvidFrameHeader::GetFrameNo (void) const
+{
+  return m_frameNo;
+}
+
+void
+EvalvidFrameHeader::SetFrameSequence (uint32_t seq)
+{
+  m_frameSeq = seq;
+}
+
+uint32_t
+EvalvidFrameHeader::GetFrameSequence (void) const
+{
+  return m_frameSeq;
+}
+
+void
+EvalvidFrameHeader::SetFrameType (EvalvidFrameTag::FrameType frameType)
+{
+  m_frameType = (uint8_t) frameType;
+}
+
+EvalvidFrameTag::FrameType
+EvalvidFrameHeader::GetFrameType (void) const
+{
+  return (EvalvidFrameTag::FrameType) m_frameType;
+}
+
+void
+EvalvidFrameHeader::SetFrameSize (uint32_t frameSize)
+{
+  m_frameSize = frameSize;
+}
+
+uint32_t
+EvalvidFrameHeader::GetFrameSize (void) const
+{
+  return m_frameSize;
+}
+
+void
+EvalvidFrameHeader::SetFragmentCount (uint16_t count)
+{
+  m_fragmentCount = count;
+}
+
+uint16_t
+EvalvidFrameHeader::GetFragmentCount (void) const
+{
+  return m_fragmentCount;
+}
+
+void
+EvalvidFrameHeader::SetFrameInterval (uint32_t interval)
+{
+  m_frameInterval = interval;
+}
+
+uint32_t
+EvalvidFrameHeader::GetFrameInterval (void) const
+{
+  return m_frameInterval;
+}
+
+void
+EvalvidFrameHeader::SetChunkId (uint32_t chunkId)
+{
+  m_chunkId = chunkId;
+}
+
+uint32_t
+EvalvidFrameHeader::GetChunkId (void) const
+{
+  return m_chunkId;
+}
+
+void
+EvalvidFrameHeader::SetChunkStartFrame (uint32_t frameNo)
+{
+  m_chunkStartFrame = frameNo;
+}
+
+uint32_t
+EvalvidFrameHeader::GetChunkStartFrame (void) const
+{
+  return m_chunkStartFrame;
+}
+
+void
+EvalvidFrameHeader::SetChunkHeadSize (uint32_t size)
+{
+  m_chunkHeadSize = size;
+}
+
+uint32_t
+EvalvidFrameHeader::GetChunkHeadSize (void) const
+{
+  return m_chunkHeadSize;
+}
+
+void
+EvalvidFrameHeader::SetChunkBitrate (double bitrate)
+{
+  m_chunkBitrate = (uint32_t) (bitrate * 1000 + 0.5);
+}
+
+double
+EvalvidFrameHeader::GetChunkBitrate (void) const
+{
+  return m_chunkBitrate / 1000.0;
+}
+
+} // namespace ns3
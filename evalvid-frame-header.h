@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_FRAME_HEADER_H__
+#define __EVALVID_FRAME_HEADER_H__
+
+#include "ns3/header.h"
+#include "evalvid-frame-tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidFrameHeader
+ * \brief Application header sent by EvalvidServer behind the SeqTsHeader.
+ *
+ * It tells the client which frame a packet belongs to and which chunk
+ * bitrate the server announced last, so that the client does not need the
+ * videoType1 and bitRate files. The chunk start frame, head size and bitrate
+ * are those written to the bitRate file at the last chunk boundary. The
+ * bitrate is carried with a resolution of 0.001 kbit/s. The frame interval
+ * paces the playout of the client.
+ */
+class EvalvidFrameHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  EvalvidFrameHeader ();
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  void SetFrameNo (uint32_t frameNo);
+  uint32_t GetFrameNo (void) const;
+  /// \param seq frames sent to the client before this one; unlike the frame number, it never repeats
+  void SetFrameSequence (uint32_t seq);
+  uint32_t GetFrameSequence (void) const;
+  void SetFrameType (EvalvidFrameTag::FrameType frameType);
+  EvalvidFrameTag::FrameType GetFrameType (void) const;
+  void SetFrameSize (uint32_t frameSize);
+  uint32_t GetFrameSize (void) const;
+  /// \param count number of packets the frame is sent in
+  void SetFragmentCount (uint16_t count);
+  uint16_t GetFragmentCount (void) const;
+  /// \param interval time since the previous frame of the trace (us), the last non zero one for frames sent with it
+  void SetFrameInterval (uint32_t interval);
+  uint32_t GetFrameInterval (void) const;
+  void SetChunkId (uint32_t chunkId);
+  uint32_t GetChunkId (void) const;
+  /// \param frameNo frame number preceding the head frame of the chunk
+  void SetChunkStartFrame (uint32_t frameNo);
+  uint32_t GetChunkStartFrame (void) const;
+  /// \param size size of the head (H) frame of the chunk in bytes
+  void SetChunkHeadSize (uint32_t size);
+  uint32_t GetChunkHeadSize (void) const;
+  /// \param bitrate bitrate of the chunk (kbit/s)
+  void SetChunkBitrate (double bitrate);
+  double GetChunkBitrate (void) const;
+
+private:
+  uint32_t m_frameNo;
+  uint32_t m_frameSeq;
+  uint8_t  m_frameType;
+  uint32_t m_frameSize;
+  uint16_t m_fragmentCount;
+  uint32_t m_frameInterval; // us
+  uint32_t m_chunkId;
+  uint32_t m_chunkStartFrame;
+  uint32_t m_chunkHeadSize;
+  uint32_t m_chunkBitrate; // 0.001 kbit/s
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_FRAME_HEADER_H__
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+
+#include "evalvid-frame-registry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidFrameRegistry");
+
+EvalvidFrameRegistry::EvalvidFrameRegistry ()
+  : m_maxPackets (65536),
+    m_nFrameAdds (0)
+{
+}
+
+void
+EvalvidFrameRegistry::Add (const EvalvidPacketInfo &info)
+{
+  NS_LOG_FUNCTION (this << info.packetId << info.uid << info.frameId);
+
+  std::unordered_map<uint32_t, EvalvidPacketInfo>::iterator it = m_packets.find (info.packetId);
+  if (it != m_packets.end ())
+    {
+      // A restarted stream reuses its packet ids.
+      it->second = info;
+    }
+  else
+    {
+      m_packets.insert (std::make_pair (info.packetId, info));
+      m_order.push_back (info.packetId);
+    }
+
+  // The packets of a frame are registered in a row: one frame entry for all.
+  FrameEntry &frame = m_frames[info.frameId];
+  if (m_frameOrder.empty () || m_frameOrder.back ().first != info.frameId)
+    {
+      frame.order = ++m_nFrameAdds;
+      m_frameOrder.push_back (std::make_pair (info.frameId, frame.order));
+    }
+  frame.info = info;
+
+  while (m_order.size () > m_maxPackets)
+    {
+      EvictFront ();
+    }
+  while (m_frameOrder.size () > m_maxPackets)
+    {
+      EvictFrontFrame ();
+    }
+}
+
+const EvalvidPacketInfo *
+EvalvidFrameRegistry::LookupByPacketId (uint32_t packetId) const
+{
+  std::unordered_map<uint32_t, EvalvidPacketInfo>::const_iterator it = m_packets.find (packetId);
+  if (it == m_packets.end ())
+    {
+      return 0;
+    }
+  return &it->second;
+}
+
+const EvalvidPacketInfo *
+EvalvidFrameRegistry::LookupByFrameId (uint32_t frameId) const
+{
+  std::unordered_map<uint32_t, FrameEntry>::const_iterator it = m_frames.find (frameId);
+  if (it == m_frames.end ())
+    {
+      return 0;
+    }
+  return &it->second.info;
+}
+
+void
+EvalvidFrameRegistry::Acknowledge (uint32_t packetId)
+{
+  NS_LOG_FUNCTION (this << packetId);
+  while (!m_order.empty () && m_order.front () <= packetId)
+    {
+      EvictFront ();
+    }
+}
+
+void
+EvalvidFrameRegistry::SetMaxPackets (uint32_t maxPackets)
+{
+  m_maxPackets = maxPackets;
+  while (m_order.size () > m_maxPackets)
+    {
+      EvictFront ();
+    }
+  while (m_frameOrder.size () > m_maxPackets)
+    {
+      EvictFrontFrame ();
+    }
+}
+
+void
+EvalvidFrameRegistry::Clear (void)
+{
+  m_order.clear ();
+  m_packets.clear ();
+  m_frameOrder.clear ();
+  m_frames.clear ();
+}
+
+void
+EvalvidFrameRegistry::EvictFront (void)
+{
+  m_packets.erase (m_order.front ());
+  m_order.pop_front ();
+}
+
+void
+EvalvidFrameRegistry::EvictFrontFrame (void)
+{
+  // Keep the entry if the frame was registered again since, e.g. by a looped video.
+  std::unordered_map<uint32_t, FrameEntry>::iterator it = m_frames.find (m_frameOrder.front ().first);
+  if (it != m_frames.end () && it->second.order == m_frameOrder.front ().second)
+    {
+      m_frames.erase (it);
+    }
+  m_frameOrder.pop_front ();
+}
+
+} // namespace ns3
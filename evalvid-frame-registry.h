@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_FRAME_REGISTRY_H__
+#define __EVALVID_FRAME_REGISTRY_H__
+
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief Frame metadata of one video packet sent by EvalvidServer.
+ */
+struct EvalvidPacketInfo
+{
+  uint32_t    packetId;   //!< Evalvid packet id, i.e. the SeqTsHeader sequence number.
+  uint64_t    uid;        //!< ns-3 packet UID at the server.
+  uint32_t    frameId;    //!< Frame number in the mp4trace file.
+  std::string frameType;  //!< Frame type as written by mp4trace ("H", "P", ...).
+  uint32_t    frameSize;  //!< Size of the whole frame in bytes.
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidFrameRegistry
+ * \brief Packet-to-frame metadata of one video session.
+ *
+ * In legacy file signalling mode, EvalvidClient registers the packets its
+ * server logs in videoType1 and looks them up by packet id, and chunk head
+ * frames by frame number, in O(1). Each client keeps its own registry, as
+ * packet ids are only unique within a session. The client acknowledges the
+ * packets it received, which evicts them; both the packets and the frames
+ * kept are capped, so that memory stays bounded even if no one
+ * acknowledges and frame numbers grow forever.
+ */
+class EvalvidFrameRegistry
+{
+public:
+  EvalvidFrameRegistry ();
+
+  /**
+   * \brief register a packet of the session
+   * \param info the packet and frame metadata
+   */
+  void Add (const EvalvidPacketInfo &info);
+
+  /**
+   * \param packetId Evalvid packet id
+   * \returns the packet metadata, or 0 if the packet is unknown or was evicted
+   */
+  const EvalvidPacketInfo *LookupByPacketId (uint32_t packetId) const;
+
+  /**
+   * \param frameId frame number in the trace
+   * \returns the metadata of the most recently registered packet of that frame, or 0
+   */
+  const EvalvidPacketInfo *LookupByFrameId (uint32_t frameId) const;
+
+  /**
+   * \brief evict every packet registered up to and including packetId
+   * \param packetId last packet id received by the client
+   */
+  void Acknowledge (uint32_t packetId);
+
+  /**
+   * \param maxPackets maximum number of unacknowledged packets, and of frames, kept
+   */
+  void SetMaxPackets (uint32_t maxPackets);
+
+  /// Remove every entry.
+  void Clear (void);
+
+private:
+  /// Frame entry, with the registration it was last refreshed by.
+  struct FrameEntry
+  {
+    EvalvidPacketInfo info;
+    uint64_t order;
+  };
+
+  void EvictFront (void);
+  void EvictFrontFrame (void);
+
+  uint32_t m_maxPackets;
+  uint64_t m_nFrameAdds;                                       // Frames registered so far
+  std::deque<uint32_t> m_order;                                // Packet ids in registration order
+  std::unordered_map<uint32_t, EvalvidPacketInfo> m_packets;   // Packet id -> metadata
+  std::deque<std::pair<uint32_t, uint64_t> > m_frameOrder;     // Frame numbers in registration order
+  std::unordered_map<uint32_t, FrameEntry> m_frames;           // Frame number -> metadata
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_FRAME_REGISTRY_H__
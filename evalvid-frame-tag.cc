@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "evalvid-frame-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (EvalvidFrameTag);
+
+TypeId
+EvalvidFrameTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidFrameTag")
+    .SetParent<Tag> ()
+    .AddConstructor<EvalvidFrameTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+EvalvidFrameTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+EvalvidFrameTag::EvalvidFrameTag ()
+  : m_frameId (0),
+    m_frameType (UNKNOWN_FRAME),
+    m_frameSize (0),
+    m_gopPosition (0),
+    m_chunkIndex (0)
+{
+}
+
+uint32_t
+EvalvidFrameTag::GetSerializedSize (void) const
+{
+  return 4 + 1 + 4 + 2 + 4;
+}
+
+void
+EvalvidFrameTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_frameId);
+  i.WriteU8 ((uint8_t) m_frameType);
+  i.WriteU32 (m_frameSize);
+  i.WriteU16 (m_gopPosition);
+  i.WriteU32 (m_chunkIndex);
+}
+
+void
+EvalvidFrameTag::Deserialize (TagBuffer i)
+{
+  m_frameId = i.ReadU32 ();
+  m_frameType = (FrameType) i.ReadU8 ();
+  m_frameSize = i.ReadU32 ();
+  m_gopPosition = i.ReadU16 ();
+  m_chunkIndex = i.ReadU32 ();
+}
+
+void
+EvalvidFrameTag::Print (std::ostream &os) const
+{
+  os << "frameId=" << m_frameId
+     << " frameType=" << GetFrameTypeString (m_frameType)
+     << " frameSize=" << m_frameSize
+     << " gopPosition=" << m_gopPosition
+     << " chunkIndex=" << m_chunkIndex;
+}
+
+void
+EvalvidFrameTag::SetFrameId (uint32_t frameId)
+{
+  m_frameId = frameId;
+}
+
+uint32_t
+EvalvidFrameTag::GetFrameId (void) const
+{
+  return m_frameId;
+}
+
+void
+EvalvidFrameTag::SetFrameType (FrameType frameType)
+{
+  m_frameType = frameType;
+}
+
+EvalvidFrameTag::FrameType
+EvalvidFrameTag::GetFrameType (void) const
+{
+  return m_frameType;
+}
+
+void
+EvalvidFrameTag::SetFrameSize (uint32_t frameSize)
+{
+  m_frameSize = frameSize;
+}
+
+uint32_t
+EvalvidFrameTag::GetFrameSize (void) const
+{
+  return m_frameSize;
+}
+
+void
+EvalvidFrameTag::SetGopPosition (uint16_t gopPosition)
+{
+  m_gopPosition = gopPosition;
+}
+
+uint16_t
+EvalvidFrameTag::GetGopPosition (void) const
+{
+  return m_gopPosition;
+}
+
+void
+EvalvidFrameTag::SetChunkIndex (uint32_t chunkIndex)
+{
+  m_chunkIndex = chunkIndex;
+}
+
+uint32_t
+EvalvidFrameTag::GetChunkIndex (void) const
+{
+  return m_chunkIndex;
+}
+
+EvalvidFrameTag::FrameType
+EvalvidFrameTag::GetFrameTypeFromString (const std::string &type)
+{
+  if (type == "H")
+    {
+      return H_FRAME;
+    }
+  else if (type == "I")
+    {
+      return I_FRAME;
+    }
+  else if (type == "P")
+    {
+      return P_FRAME;
+    }
+  else if (type == "B")
+    {
+      return B_FRAME;
+    }
+  return UNKNOWN_FRAME;
+}
+
+std::string
+EvalvidFrameTag::GetFrameTypeString (FrameType type)
+{
+  switch (type)
+    {
+    case H_FRAME:
+      return "H";
+    case I_FRAME:
+      return "I";
+    case P_FRAME:
+      return "P";
+    case B_FRAME:
+      return "B";
+    default:
+      return "?";
+    }
+}
+
+} // namespace ns3
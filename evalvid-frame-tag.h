@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_FRAME_TAG_H__
+#define __EVALVID_FRAME_TAG_H__
+
+#include "ns3/tag.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidFrameTag
+ * \brief Packet tag describing the video frame a packet belongs to.
+ *
+ * EvalvidServer attaches this tag to every fragment it sends. Packet tags
+ * are kept by Packet::Copy and by header addition and removal, so the tag
+ * is still present when the SDU reaches LteRlcUm after UDP, IP, GTP-U and
+ * PDCP encapsulation, and the RLC can classify it with PeekPacketTag.
+ */
+class EvalvidFrameTag : public Tag
+{
+public:
+  /// Frame types as written by the mp4trace tool.
+  enum FrameType
+  {
+    UNKNOWN_FRAME = 0,
+    H_FRAME       = 1,
+    I_FRAME       = 2,
+    P_FRAME       = 3,
+    B_FRAME       = 4
+  };
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  EvalvidFrameTag ();
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  void SetFrameId (uint32_t frameId);
+  uint32_t GetFrameId (void) const;
+  void SetFrameType (FrameType frameType);
+  FrameType GetFrameType (void) const;
+  void SetFrameSize (uint32_t frameSize);
+  uint32_t GetFrameSize (void) const;
+  /// \param gopPosition number of frames since the last H/I frame (0 for the H/I frame itself)
+  void SetGopPosition (uint16_t gopPosition);
+  uint16_t GetGopPosition (void) const;
+  void SetChunkIndex (uint32_t chunkIndex);
+  uint32_t GetChunkIndex (void) const;
+
+  /**
+   * \param type frame type string of a trace file ("H", "I", "P" or "B")
+   * \returns the matching FrameType, UNKNOWN_FRAME if none matches
+   */
+  static FrameType GetFrameTypeFromString (const std::string &type);
+  /**
+   * \param type a frame type
+   * \returns the trace file string of the frame type
+   */
+  static std::string GetFrameTypeString (FrameType type);
+
+private:
+  uint32_t  m_frameId;
+  FrameType m_frameType;
+  uint32_t  m_frameSize;
+  uint16_t  m_gopPosition;
+  uint32_t  m_chunkIndex;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_FRAME_TAG_H__
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+#include "evalvid-frame-tracker.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidFrameTracker");
+
+EvalvidFrameTracker::EvalvidFrameTracker ()
+{
+  SetCapacity (8192);
+}
+
+void
+EvalvidFrameTracker::SetCapacity (uint32_t frames)
+{
+  NS_ABORT_MSG_IF (frames == 0, "EvalvidFrameTracker: empty ring");
+  Slot empty;
+  empty.seq = 0;
+  empty.frameNo = 0;
+  empty.expected = 0;
+  empty.received = 0;
+  empty.bytes = 0;
+  empty.interval = 0;
+  empty.type = EvalvidFrameTag::UNKNOWN_FRAME;
+  empty.status = FRAME_PENDING;
+  m_ring.assign (frames, empty);
+  m_nextSeq = 0;
+  m_lastFrameNo = 0;
+  m_started = false;
+  m_chainIntact = false;
+  m_played = 0;
+  m_playedBytes = 0;
+  m_playedInterval = 0;
+  for (uint32_t i = 0; i <= FRAME_LOST; i++)
+    {
+      m_counts[i] = 0;
+    }
+}
+
+void
+EvalvidFrameTracker::SetFrameCallback (FrameCallback cb)
+{
+  m_frameCallback = cb;
+}
+
+bool
+EvalvidFrameTracker::AddFragment (uint32_t seq, uint32_t frameNo, EvalvidFrameTag::FrameType type,
+                                  uint16_t fragments, uint32_t size, uint32_t interval)
+{
+  if (!m_started)
+    {
+      m_nextSeq = seq;
+      m_lastFrameNo = frameNo - 1;
+      m_started = true;
+    }
+  Slot &slot = m_ring[seq % m_ring.size ()];
+  if (seq < m_nextSeq)
+    {
+      // Already played: the slot still holds the frame unless it was reused.
+      if (slot.seq != seq)
+        {
+          return false;
+        }
+      if (slot.status == FRAME_LOST && slot.expected == 0)
+        {
+          // Nothing had arrived at the playout: the fragment count is first known now.
+          slot.expected = fragments;
+        }
+      slot.received++;
+      if (slot.received >= slot.expected
+          && (slot.status == FRAME_PARTIAL || slot.status == FRAME_LOST))
+        {
+          m_counts[slot.status]--;
+          m_counts[FRAME_LATE]++;
+          slot.status = FRAME_LATE;
+        }
+      return false;
+    }
+  if (seq - m_nextSeq >= m_ring.size ())
+    {
+      NS_LOG_WARN ("EvalvidFrameTracker: frame " << frameNo << " more than " << m_ring.size ()
+                   << " frames ahead of the playout, not tracked");
+      return false;
+    }
+  if (slot.seq != seq || slot.status != FRAME_PENDING)
+    {
+      slot.seq = seq;
+      slot.frameNo = frameNo;
+      slot.expected = fragments;
+      slot.received = 0;
+      slot.bytes = 0;
+      slot.interval = interval;
+      slot.type = type;
+      slot.status = FRAME_PENDING;
+    }
+  slot.received++;
+  slot.bytes += size;
+  return true;
+}
+
+const EvalvidFrameTracker::Slot &
+EvalvidFrameTracker::Finalize (void)
+{
+  Slot &slot = m_ring[m_nextSeq % m_ring.size ()];
+  if (slot.seq != m_nextSeq || slot.status != FRAME_PENDING)
+    {
+      // Nothing arrived; the type is unknown, so assume it was a reference.
+      slot.seq = m_nextSeq;
+      slot.frameNo = m_lastFrameNo + 1;
+      slot.expected = 0;
+      slot.received = 0;
+      slot.bytes = 0;
+      slot.interval = 0;
+      slot.type = EvalvidFrameTag::UNKNOWN_FRAME;
+      slot.status = FRAME_LOST;
+      m_chainIntact = false;
+    }
+  else if (slot.received < slot.expected)
+    {
+      slot.status = FRAME_PARTIAL;
+      if (slot.type != EvalvidFrameTag::B_FRAME && slot.type != EvalvidFrameTag::H_FRAME)
+        {
+          m_chainIntact = false;
+        }
+    }
+  else
+    {
+      switch (slot.type)
+        {
+        case EvalvidFrameTag::I_FRAME:
+          m_chainIntact = true;
+          slot.status = FRAME_COMPLETE;
+          break;
+        case EvalvidFrameTag::P_FRAME:
+        case EvalvidFrameTag::B_FRAME:
+          // An undecodable P frame leaves the chain broken until the next I frame.
+          slot.status = m_chainIntact ? FRAME_COMPLETE : FRAME_UNDECODABLE;
+          break;
+        default:
+          slot.status = FRAME_COMPLETE;
+          break;
+        }
+    }
+  if (slot.type != EvalvidFrameTag::H_FRAME)
+    {
+      m_counts[slot.status]++;
+      m_played++;
+    }
+  m_nextSeq++;
+  m_lastFrameNo = slot.frameNo;
+  if (!m_frameCallback.IsNull ())
+    {
+      m_frameCallback (slot.frameNo, static_cast<EvalvidFrameTag::FrameType> (slot.type),
+                       static_cast<FrameStatus> (slot.status));
+    }
+  return slot;
+}
+
+EvalvidFrameTracker::FrameStatus
+EvalvidFrameTracker::PlayFrame (void)
+{
+  if (!m_started)
+    {
+      return FRAME_PENDING;
+    }
+  const Slot *slot;
+  m_playedBytes = 0;
+  do
+    {
+      slot = &Finalize ();
+      m_playedBytes += slot->bytes;
+    }
+  while (slot->type == EvalvidFrameTag::H_FRAME);
+  m_playedInterval = slot->interval;
+  return static_cast<FrameStatus> (slot->status);
+}
+
+uint32_t
+EvalvidFrameTracker::GetPlayedBytes (void) const
+{
+  return m_playedBytes;
+}
+
+uint32_t
+EvalvidFrameTracker::GetPlayedInterval (void) const
+{
+  return m_playedInterval;
+}
+
+uint32_t
+EvalvidFrameTracker::GetNextSequence (void) const
+{
+  return m_nextSeq;
+}
+
+uint32_t
+EvalvidFrameTracker::GetNFrames (FrameStatus status) const
+{
+  return m_counts[status];
+}
+
+uint32_t
+EvalvidFrameTracker::GetNPlayed (void) const
+{
+  return m_played;
+}
+
+double
+EvalvidFrameTracker::GetDecodableFrameRate (void) const
+{
+  return m_played > 0 ? (double) m_counts[FRAME_COMPLETE] / m_played : 0;
+}
+
+std::string
+EvalvidFrameTracker::GetStatusString (FrameStatus status)
+{
+  switch (status)
+    {
+    case FRAME_PENDING:
+      return "pending";
+    case FRAME_COMPLETE:
+      return "complete";
+    case FRAME_PARTIAL:
+      return "partial";
+    case FRAME_LATE:
+      return "late";
+    case FRAME_UNDECODABLE:
+      return "undecodable";
+    case FRAME_LOST:
+      return "lost";
+    }
+  return "unknown";
+}
+
+} // namespace ns3
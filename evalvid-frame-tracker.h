@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_FRAME_TRACKER_H__
+#define __EVALVID_FRAME_TRACKER_H__
+
+#include "ns3/callback.h"
+#include "evalvid-frame-tag.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidFrameTracker
+ * \brief Frame reassembly and decodability at the client.
+ *
+ * Every received fragment is counted in the slot of its frame in a ring
+ * indexed by the sequence number of the frame in the session; the frame
+ * header tells how many fragments the frame was sent in. Frame numbers
+ * repeat when the server loops the trace or switches rendition, so they
+ * are only reported. When the playout reaches a frame, the frame is
+ * complete if all its fragments arrived, partial if some did and lost if
+ * none did. A complete frame is undecodable if its reference chain is
+ * broken: frames arrive in decoding order, so P and B frames depend on the
+ * I and P frames since the last I frame, which must all have been complete
+ * and decodable. A partial or lost frame that completes after its playout
+ * is counted as late instead. H frames carry no picture and are played
+ * with the frame that follows them.
+ *
+ * The decodable frame rate is the share of played frames that were
+ * decodable, as computed offline by the Evalvid reconstruction. The bytes
+ * received for the frames and their interval in the trace let the client
+ * drain its playback buffer and pace its playout frame by frame.
+ */
+class EvalvidFrameTracker
+{
+public:
+  /// Status of a frame.
+  enum FrameStatus
+  {
+    FRAME_PENDING     = 0,  //!< Not played yet.
+    FRAME_COMPLETE    = 1,  //!< Complete and decodable at its playout.
+    FRAME_PARTIAL     = 2,  //!< Some fragments missing at its playout.
+    FRAME_LATE        = 3,  //!< Completed after its playout.
+    FRAME_UNDECODABLE = 4,  //!< Complete, but a reference frame was not decodable.
+    FRAME_LOST        = 5   //!< No fragment at its playout.
+  };
+
+  /// Invoked for every played frame: frame number, frame type and status.
+  /// A lost frame is reported with the number following the previous one.
+  typedef Callback<void, uint32_t, EvalvidFrameTag::FrameType, FrameStatus> FrameCallback;
+
+  EvalvidFrameTracker ();
+
+  /// \param frames number of frames tracked ahead of the playout; clears the tracker
+  void SetCapacity (uint32_t frames);
+  /// \param cb callback invoked for every played frame
+  void SetFrameCallback (FrameCallback cb);
+
+  /**
+   * \brief account a received fragment
+   * \param seq sequence number of the frame in the session
+   * \param frameNo frame number
+   * \param type frame type
+   * \param fragments number of fragments of the frame
+   * \param size size of the fragment in bytes
+   * \param interval interval of the frame in the trace (us), 0 if unknown
+   * \returns true if the fragment waits for the playout of its frame, false if
+   *          the frame was already played or is not tracked
+   */
+  bool AddFragment (uint32_t seq, uint32_t frameNo, EvalvidFrameTag::FrameType type,
+                    uint16_t fragments, uint32_t size, uint32_t interval);
+
+  /**
+   * \brief play the next frame, and the H frames before it
+   * \returns the status of the played frame, FRAME_PENDING before the first fragment
+   */
+  FrameStatus PlayFrame (void);
+
+  /// \returns the bytes received for the frames of the last PlayFrame, H frames included
+  uint32_t GetPlayedBytes (void) const;
+  /// \returns the interval (us) of the frame of the last PlayFrame, 0 if unknown
+  uint32_t GetPlayedInterval (void) const;
+  /// \returns the sequence number of the next frame to play
+  uint32_t GetNextSequence (void) const;
+  /// \returns the number of played frames of a status; H frames are not counted
+  uint32_t GetNFrames (FrameStatus status) const;
+  /// \returns the number of played frames; H frames are not counted
+  uint32_t GetNPlayed (void) const;
+  /// \returns the share of played frames that were decodable, 0 before the first
+  double GetDecodableFrameRate (void) const;
+
+  static std::string GetStatusString (FrameStatus status);
+
+private:
+  struct Slot
+  {
+    uint32_t seq;
+    uint32_t frameNo;
+    uint16_t expected;  //!< Fragments of the frame.
+    uint16_t received;
+    uint32_t bytes;     //!< Bytes received before the playout.
+    uint32_t interval;  //!< Interval of the frame in the trace (us).
+    uint8_t  type;      //!< An EvalvidFrameTag::FrameType.
+    uint8_t  status;    //!< A FrameStatus.
+  };
+
+  /// Finalize the status of the next frame and move to the following one.
+  const Slot &Finalize (void);
+
+  std::vector<Slot> m_ring;
+  uint32_t m_nextSeq;
+  uint32_t m_lastFrameNo;  //!< Number of the last played frame.
+  bool m_started;
+  bool m_chainIntact;  //!< The anchors since the last I frame were decodable.
+  uint32_t m_played;
+  uint32_t m_playedBytes;
+  uint32_t m_playedInterval;
+  uint32_t m_counts[FRAME_LOST + 1];
+  FrameCallback m_frameCallback;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_FRAME_TRACKER_H__
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/singleton.h"
+
+#include "evalvid-hint-bus.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidHintBus");
+
+EvalvidHintBus::EvalvidHintBus ()
+  : m_nextId (1),
+    m_count (0)
+{
+}
+
+EvalvidHintBus *
+EvalvidHintBus::Get (void)
+{
+  return Singleton<EvalvidHintBus>::Get ();
+}
+
+uint64_t
+EvalvidHintBus::GetKey (uint16_t cellId, uint16_t rnti, uint8_t lcid)
+{
+  return ((uint64_t) cellId << 24) | ((uint64_t) rnti << 8) | lcid;
+}
+
+uint32_t
+EvalvidHintBus::Subscribe (uint16_t cellId, uint16_t rnti, uint8_t lcid, HintCallback cb)
+{
+  NS_LOG_FUNCTION (this << cellId << rnti << (uint32_t) lcid);
+  Subscription subscription;
+  subscription.id = m_nextId++;
+  subscription.cb = cb;
+  m_subscriptions[GetKey (cellId, rnti, lcid)].push_back (subscription);
+  m_count++;
+  return subscription.id;
+}
+
+void
+EvalvidHintBus::Unsubscribe (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  for (std::unordered_map<uint64_t, SubscriptionList>::iterator it = m_subscriptions.begin ();
+       it != m_subscriptions.end (); ++it)
+    {
+      for (SubscriptionList::iterator sit = it->second.begin (); sit != it->second.end (); ++sit)
+        {
+          if (sit->id == id)
+            {
+              it->second.erase (sit);
+              if (it->second.empty ())
+                {
+                  m_subscriptions.erase (it);
+                }
+              m_count--;
+              return;
+            }
+        }
+    }
+}
+
+void
+EvalvidHintBus::Publish (const EvalvidCongestionHint &hint)
+{
+  if (m_count == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << hint.cellId << hint.rnti << (uint32_t) hint.lcid << hint.event << hint.txBufferSize);
+  // Every combination of the fields of the hint and wildcards, each once.
+  uint16_t cellIds[2] = { hint.cellId, 0 };
+  uint16_t rntis[2] = { hint.rnti, 0 };
+  uint8_t lcids[2] = { hint.lcid, 0 };
+  for (uint32_t c = 0; c < (hint.cellId != 0 ? 2u : 1u); c++)
+    {
+      for (uint32_t r = 0; r < (hint.rnti != 0 ? 2u : 1u); r++)
+        {
+          for (uint32_t l = 0; l < (hint.lcid != 0 ? 2u : 1u); l++)
+            {
+              Deliver (GetKey (cellIds[c], rntis[r], lcids[l]), hint);
+            }
+        }
+    }
+}
+
+void
+EvalvidHintBus::Deliver (uint64_t key, const EvalvidCongestionHint &hint)
+{
+  std::unordered_map<uint64_t, SubscriptionList>::const_iterator it = m_subscriptions.find (key);
+  if (it == m_subscriptions.end ())
+    {
+      return;
+    }
+  for (SubscriptionList::const_iterator sit = it->second.begin (); sit != it->second.end (); ++sit)
+    {
+      sit->cb (hint);
+    }
+}
+
+} // namespace ns3
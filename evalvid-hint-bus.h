@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_HINT_BUS_H__
+#define __EVALVID_HINT_BUS_H__
+
+#include "ns3/callback.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief Cross-layer congestion hint published by LteRlcUm for every SDU.
+ *
+ * Only eNB-side instances publish, labelled with their cell: RNTIs are
+ * unique within a cell only.
+ */
+struct EvalvidCongestionHint
+{
+  /// What happened to the SDU that triggered the hint.
+  enum Event
+  {
+    QUEUED          = 0, //!< The SDU was queued.
+    WIRELESS_LOSS   = 1, //!< The SDU was discarded by the RLC error model.
+    BUFFER_FULL     = 2, //!< The SDU was discarded because the tx buffer is full.
+    CONGESTION_LOSS = 3  //!< Like BUFFER_FULL, and the two SDUs before were discarded too.
+  };
+
+  uint16_t cellId;
+  uint16_t rnti;
+  uint8_t  lcid;
+  Event    event;
+  uint32_t txBufferSize;     //!< Bytes in the tx buffer after handling the SDU.
+  uint32_t maxTxBufferSize;  //!< Size of the tx buffer in bytes.
+  double   nackRatio;        //!< Last value of LteRlcUm::calNackRatio ().
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidHintBus
+ * \brief In-process publish/subscribe bus for congestion hints.
+ *
+ * Subscriptions are keyed by cell id, RNTI and LCID; 0 acts as a wildcard
+ * for any of them, so (0, 0, 0) receives the hints of every bearer. Publishing with no
+ * subscriber costs a single counter test. Callbacks must not subscribe or
+ * unsubscribe while a hint is being delivered.
+ */
+class EvalvidHintBus
+{
+public:
+  typedef Callback<void, const EvalvidCongestionHint &> HintCallback;
+
+  EvalvidHintBus ();
+
+  /**
+   * \returns the bus shared by all LteRlcUm and EvalvidServer instances of
+   * this process.
+   */
+  static EvalvidHintBus *Get (void);
+
+  /**
+   * \param cellId cell to listen to, 0 for any
+   * \param rnti RNTI to listen to, 0 for any
+   * \param lcid LCID to listen to, 0 for any
+   * \param cb callback invoked for every matching hint
+   * \returns an id to pass to Unsubscribe
+   */
+  uint32_t Subscribe (uint16_t cellId, uint16_t rnti, uint8_t lcid, HintCallback cb);
+
+  /// \param id id returned by Subscribe
+  void Unsubscribe (uint32_t id);
+
+  /// \param hint hint to deliver to the matching subscribers
+  void Publish (const EvalvidCongestionHint &hint);
+
+private:
+  struct Subscription
+  {
+    uint32_t     id;
+    HintCallback cb;
+  };
+  typedef std::vector<Subscription> SubscriptionList;
+
+  static uint64_t GetKey (uint16_t cellId, uint16_t rnti, uint8_t lcid);
+  void Deliver (uint64_t key, const EvalvidCongestionHint &hint);
+
+  uint32_t m_nextId;
+  uint32_t m_count;
+  std::unordered_map<uint64_t, SubscriptionList> m_subscriptions;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_HINT_BUS_H__
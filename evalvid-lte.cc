@@ -19,10 +19,14 @@
  */
 
 #include <fstream>
+#include <iostream>
+#include <sstream>
 #include <string.h>
 
 #include "ns3/csma-helper.h"
 #include "ns3/evalvid-client-server-helper.h"
+#include "ns3/evalvid-client.h"
+#include "ns3/evalvid-qoe.h"
 
 #include "ns3/lte-helper.h"
 #include "ns3/epc-helper.h"
@@ -51,6 +55,20 @@ using namespace ns3;
  
 NS_LOG_COMPONENT_DEFINE ("EvalvidLTEExample");
 
+/**
+ * Labels the RLC instances of the data bearers of a UE at its eNB with the
+ * cell, so that they, and not those of the UE, publish congestion hints.
+ */
+static void
+LabelEnbRlc (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  std::string rrcPath = context.substr (0, context.rfind ("/"));
+  std::ostringstream path;
+  path << rrcPath << "/UeMap/" << rnti
+       << "/DataRadioBearerMap/*/LteRlc/$ns3::LteRlcUm/HintCellId";
+  Config::Set (path.str (), UintegerValue (cellId));
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -67,6 +85,10 @@ main (int argc, char *argv[])
   // double interPacketInterval = 100;
   uint16_t port = 8000;
 
+  CommandLine cmd;
+  cmd.AddValue ("numberOfNodes", "Number of eNodeBs, with one UE and one video client each", numberOfNodes);
+  cmd.Parse (argc, argv);
+
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
   //Ptr<EpcHelper>  epcHelper = CreateObject<EpcHelper> ();
   Ptr<PointToPointEpcHelper>  epcHelper = CreateObject<PointToPointEpcHelper> ();
@@ -148,14 +170,19 @@ main (int argc, char *argv[])
   ueIpIface = epcHelper->AssignUeIpv4Address (NetDeviceContainer (ueLteDevs));
   // Assign IP address to UEs, and install applications
 
-  Ptr<Node> ueNode = ueNodes.Get (0);
-  // Set the default gateway for the UE
-  Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNode->GetObject<Ipv4> ());
-  ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+  for (uint16_t i = 0; i < numberOfNodes; i++)
+    {
+      Ptr<Node> ueNode = ueNodes.Get (i);
+      // Set the default gateway for the UE
+      Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNode->GetObject<Ipv4> ());
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
 
-  // Attach one UE per eNodeB
-  lteHelper->Attach (ueLteDevs.Get(0), enbLteDevs.Get(0));
+      // Attach one UE per eNodeB
+      lteHelper->Attach (ueLteDevs.Get(i), enbLteDevs.Get(i));
+    }
   // lteHelper->ActivateEpsBearer (ueLteDevs, EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT), EpcTft::Default ());
+  Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionReconfiguration",
+                   MakeCallback (&LabelEnbRlc));
   
   NS_LOG_INFO ("Create Applications.");
   
@@ -166,11 +193,25 @@ main (int argc, char *argv[])
   apps.Start (Seconds (0.0));
   apps.Stop (Seconds (99.0));
   
-  EvalvidClientHelper client (internetIpIfaces.GetAddress (1), port);
-  client.SetAttribute ("ReceiverDumpFilename", StringValue("rd"));
-  apps = client.Install (ueNodes.Get(0));
-  apps.Start (Seconds (1.0));
-  apps.Stop (Seconds (100.0));  
+  // One client per UE. The ClientId suffixes the outputs of all but the
+  // first with _<id>, at the client and at the server, and so does rd here.
+  ApplicationContainer clientApps;
+  for (uint16_t i = 0; i < numberOfNodes; i++)
+    {
+      std::ostringstream rd;
+      rd << "rd";
+      if (i > 0)
+        {
+          rd << "_" << i;
+        }
+      EvalvidClientHelper client (internetIpIfaces.GetAddress (1), port);
+      client.SetAttribute ("ReceiverDumpFilename", StringValue(rd.str ()));
+      client.SetAttribute ("ClientId", UintegerValue (i));
+      clientApps.Add (client.Install (ueNodes.Get(i)));
+    }
+  // Stopped before the simulation, so that the clients close their sessions.
+  clientApps.Start (Seconds (1.0));
+  clientApps.Stop (Seconds (99.0));  
 
   // Set the CBR application on the cbrHost
   OnOffHelper onOff ("ns3::UdpSocketFactory",
@@ -187,6 +228,18 @@ main (int argc, char *argv[])
   NS_LOG_INFO ("Run Simulation.");
   Simulator::Stop(Seconds(100));
   Simulator::Run ();         
+
+  // P.1201 MOS of the sessions of all the UEs, evaluated at once.
+  EvalvidQoeBatch qoe;
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      qoe.Add (DynamicCast<EvalvidClient> (clientApps.Get (i))->GetQoeInputs ());
+    }
+  const std::vector<double> &mos = qoe.Evaluate ();
+  for (uint32_t i = 0; i < mos.size (); i++)
+    {
+      std::cout << "UE " << i << ": session MOS " << mos[i] << std::endl;
+    }
   Simulator::Destroy ();
   
   NS_LOG_INFO ("Done.");
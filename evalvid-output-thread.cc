@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+#include "ns3/singleton.h"
+
+#include "evalvid-output-thread.h"
+#include "evalvid-dump-writer.h"
+
+#include <chrono>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidOutputThread");
+
+static_assert ((EvalvidOutputThread::CAPACITY & (EvalvidOutputThread::CAPACITY - 1)) == 0,
+               "EvalvidOutputThread::CAPACITY must be a power of two");
+
+EvalvidOutputThread::EvalvidOutputThread ()
+  : m_ring (CAPACITY),
+    m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_running (false),
+    m_stalls (0),
+    m_stallTime (0)
+{
+}
+
+EvalvidOutputThread::~EvalvidOutputThread ()
+{
+  Stop ();
+}
+
+EvalvidOutputThread *
+EvalvidOutputThread::Get (void)
+{
+  return Singleton<EvalvidOutputThread>::Get ();
+}
+
+void
+EvalvidOutputThread::Start (void)
+{
+  if (m_running)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_stop.store (false);
+  m_thread = Create<SystemThread> (MakeCallback (&EvalvidOutputThread::Run, this));
+  m_thread->Start ();
+  m_running = true;
+  Simulator::ScheduleDestroy (&EvalvidOutputThread::Stop, this);
+}
+
+void
+EvalvidOutputThread::Stop (void)
+{
+  if (!m_running)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_stop.store (true, std::memory_order_release);
+  m_thread->Join ();
+  m_thread = 0;
+  m_running = false;
+  // Records pushed after the thread saw the stop flag.
+  RunRecords ();
+  NS_LOG_INFO (">> EvalvidOutputThread: " << GetPushed () << " records, " << m_stalls
+               << " stalls on a full ring, " << m_stallTime << "s stalled");
+}
+
+bool
+EvalvidOutputThread::IsRunning (void) const
+{
+  return m_running;
+}
+
+void
+EvalvidOutputThread::Push (const EvalvidOutputRecord &record)
+{
+  if (!m_running)
+    {
+      record.writer->Execute (record);
+      return;
+    }
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  if (head - m_tail.load (std::memory_order_acquire) == CAPACITY)
+    {
+      // Back-pressure: wait for the thread to free a slot.
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+      while (head - m_tail.load (std::memory_order_acquire) == CAPACITY)
+        {
+          std::this_thread::yield ();
+        }
+      m_stalls++;
+      m_stallTime += std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+    }
+  m_ring[head & (CAPACITY - 1)] = record;
+  m_head.store (head + 1, std::memory_order_release);
+}
+
+void
+EvalvidOutputThread::Drain (void)
+{
+  if (!m_running)
+    {
+      return;
+    }
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  while (m_tail.load (std::memory_order_acquire) != head)
+    {
+      std::this_thread::yield ();
+    }
+}
+
+uint64_t
+EvalvidOutputThread::GetPushed (void) const
+{
+  return m_head.load (std::memory_order_relaxed);
+}
+
+uint64_t
+EvalvidOutputThread::GetStalls (void) const
+{
+  return m_stalls;
+}
+
+double
+EvalvidOutputThread::GetStallTime (void) const
+{
+  return m_stallTime;
+}
+
+bool
+EvalvidOutputThread::RunRecords (void)
+{
+  uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  uint64_t head = m_head.load (std::memory_order_acquire);
+  if (tail == head)
+    {
+      return false;
+    }
+  for (; tail != head; tail++)
+    {
+      const EvalvidOutputRecord &record = m_ring[tail & (CAPACITY - 1)];
+      record.writer->Execute (record);
+      // Free the slot at once, so that a stalled producer resumes early.
+      m_tail.store (tail + 1, std::memory_order_release);
+    }
+  return true;
+}
+
+void
+EvalvidOutputThread::Run (void)
+{
+  for (;;)
+    {
+      bool stop = m_stop.load (std::memory_order_acquire);
+      if (!RunRecords ())
+        {
+          if (stop)
+            {
+              return;
+            }
+          std::this_thread::sleep_for (std::chrono::microseconds (200));
+        }
+    }
+}
+
+} // namespace ns3
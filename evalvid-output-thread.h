@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_OUTPUT_THREAD_H__
+#define __EVALVID_OUTPUT_THREAD_H__
+
+#include "ns3/ptr.h"
+#include "ns3/system-thread.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+namespace ns3 {
+
+class EvalvidDumpWriter;
+
+/**
+ * \ingroup Evalvid
+ * \brief One output line, as pushed by the simulation to the output thread.
+ *
+ * The fields are the arguments of the EvalvidDumpWriter call that made the
+ * record; their meaning depends on op.
+ */
+struct EvalvidOutputRecord
+{
+  EvalvidDumpWriter *writer;
+  uint32_t op;        //!< An EvalvidDumpWriter::Op.
+  uint32_t u32[3];
+  uint64_t u64;
+  double   d[3];
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidOutputThread
+ * \brief Thread formatting and writing the outputs of the Evalvid applications.
+ *
+ * The simulation pushes records into a single-producer single-consumer
+ * ring; the thread pops them and runs them on their EvalvidDumpWriter, so
+ * formatting and disk writes leave the event loop. Only the simulation
+ * thread may push.
+ *
+ * When the ring is full the simulation waits for the thread; the number of
+ * such stalls and the time spent in them are logged when the thread stops.
+ * The thread starts with the first asynchronous writer and stops at
+ * Simulator::Destroy, after writing every record. Records pushed while it
+ * is stopped are run at once by the pushing thread.
+ */
+class EvalvidOutputThread
+{
+public:
+  /// Records of the ring, a power of two.
+  static const uint32_t CAPACITY = 1 << 16;
+
+  EvalvidOutputThread ();
+  ~EvalvidOutputThread ();
+
+  /// \returns the output thread of this process.
+  static EvalvidOutputThread *Get (void);
+
+  /// Start the thread if it is not running, and stop it at Simulator::Destroy.
+  void Start (void);
+  /// Write every record pushed so far and stop the thread.
+  void Stop (void);
+  bool IsRunning (void) const;
+
+  /// \param record the record to write; waits while the ring is full
+  void Push (const EvalvidOutputRecord &record);
+  /// Wait until every record pushed so far is written.
+  void Drain (void);
+
+  uint64_t GetPushed (void) const;
+  /// \returns the number of pushes that found the ring full
+  uint64_t GetStalls (void) const;
+  /// \returns the wall clock time (s) the simulation waited for room in the ring
+  double GetStallTime (void) const;
+
+private:
+  /// Consumer loop of the thread.
+  void Run (void);
+  /// Run the records pushed so far; \returns false if there were none.
+  bool RunRecords (void);
+
+  std::vector<EvalvidOutputRecord> m_ring;
+  std::atomic<uint64_t> m_head;  // Records pushed, written by the producer
+  std::atomic<uint64_t> m_tail;  // Records run, written by the consumer
+  std::atomic<bool> m_stop;
+  Ptr<SystemThread> m_thread;
+  bool m_running;
+  uint64_t m_stalls;
+  double m_stallTime;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_OUTPUT_THREAD_H__
@@ -0,0 +1,517 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "evalvid-qoe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+
+/*
+ * ITU-T P.1201 coefficients, with the approximations the model was
+ * implemented with in EvalvidClient: log (1000/30) is taken with the integer
+ * division, log (33), and e as 2.718.
+ */
+static constexpr double P1201_ABIF = 46000;            // average bytes per I-frame
+static constexpr double P1201_NBR = 8.0 / 1000;        // Eq. 6-31, kbit/s to bits per frame
+static constexpr double P1201_CCF_MAX = 1.10;          // Eq. 6-32
+static constexpr double P1201_DC[3] = { 104.0, 0.01, 1.1 };  // Eq. 6-40
+static constexpr double P1201_MOSC[2] = { 3.4, 0.969 };      // Eq. 6-38
+static constexpr double P1201_LOG_FRAME_INTERVAL = 3.4965075614664802;  // log (1000/30)
+static constexpr double P1201_BUFFER[4] = { 1.66, 1.72, 0.04, 0.36 };   // III-1
+static constexpr double P1201_LOG_E = 0.999896315728952;                // log (2.718)
+static constexpr double P1201_INTEGRATION[4] = { 0.4175, 0.4175, 0.0247, 0.1403 };  // O.41
+
+/* O.23, also O.32: 0.7977*o23 + 0.02472*o23 with audio */
+static inline double
+CodingMos (double bitrate)
+{
+  double ccf = std::min (std::sqrt (bitrate / (P1201_ABIF * 15.0)), P1201_CCF_MAX);
+  double nbr = bitrate * P1201_NBR;
+  double dc = 4 / (1 + std::pow (nbr / (P1201_DC[0] * ccf + 1.0), P1201_DC[1] * ccf + P1201_DC[2]));
+  return (5 - dc) * (1 + P1201_MOSC[0] * ccf - P1201_MOSC[1] * ccf * P1201_LOG_FRAME_INTERVAL);
+}
+
+/* O.24 of interruptions, O.25 of overflows; the initial loading degradation is 0 */
+static inline double
+BufferMos (double length, double count)
+{
+  double degradation = P1201_BUFFER[0]
+    - P1201_BUFFER[1] * std::exp (P1201_LOG_E * (-P1201_BUFFER[2] * length - P1201_BUFFER[3]) * count);
+  return 5 - std::min (std::max (degradation, 0.0), 4.0);
+}
+
+static inline double
+IntegrationMos (double codingMos, double stallMos, double overflowMos)
+{
+  double bufferMos = P1201_INTEGRATION[0] * stallMos + P1201_INTEGRATION[1] * overflowMos
+    + P1201_INTEGRATION[2] * stallMos * overflowMos + P1201_INTEGRATION[3];
+  return std::min (std::max (codingMos - 5 + bufferMos, 1.0), 5.0);
+}
+
+#if defined (__GNUC__)
+/*
+ * The array versions work on two periods at a time with the GCC and Clang
+ * vector extensions, which compile to SSE2 or NEON instructions at any
+ * optimization level and without -ffast-math; 128-bit vectors keep the
+ * ABI of the helpers the same with and without AVX. The libm calls of the
+ * scalar model do not vectorize without -ffast-math, so pow, exp and sqrt
+ * are built here from Exp2 and Log2, both within a few ulp of libm; the
+ * MOS agree with the scalar model to about 1e-14.
+ */
+typedef double V2d __attribute__ ((vector_size (16)));
+typedef int64_t V2l __attribute__ ((vector_size (16)));
+
+static constexpr double ROUND_SHIFT = 6755399441055744.0;  // 1.5 * 2^52
+static constexpr double LN2 = 0.6931471805599453;
+static constexpr double LOG2E = 1.4426950408889634;
+static constexpr double SQRT2 = 1.4142135623730951;
+/* 1/k!, k = 12 to 0: 2^f = e^(f ln 2) for |f| <= 0.5, error below 1e-16 */
+static constexpr double EXP_TAYLOR[13] = {
+  1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880, 1.0 / 40320, 1.0 / 5040,
+  1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 1.0 / 2, 1.0, 1.0
+};
+/* 1/k, k = 21 to 1 odd: atanh s / s for |s| <= 0.1716, error below 1e-16 */
+static constexpr double ATANH_TAYLOR[11] = {
+  1.0 / 21, 1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1.0
+};
+
+static inline V2d
+Splat (double x)
+{
+  V2d v = { x, x };
+  return v;
+}
+
+/* a where mask is set, b elsewhere */
+static inline V2d
+Select (V2l mask, V2d a, V2d b)
+{
+  return (V2d) (((V2l) a & mask) | ((V2l) b & ~mask));
+}
+
+static inline V2d
+Min (V2d a, V2d b)
+{
+  return Select (a < b, a, b);
+}
+
+static inline V2d
+Max (V2d a, V2d b)
+{
+  return Select (a > b, a, b);
+}
+
+/* 2^x, x clamped to [-1022, 1023]: 2^n built in the exponent bits, n the
+ * nearest integer to x, times the polynomial of 2^(x-n). */
+static inline V2d
+Exp2 (V2d x)
+{
+  x = Min (Max (x, Splat (-1022)), Splat (1023));
+  V2d shifted = x + ROUND_SHIFT;
+  V2d f = (x - (shifted - ROUND_SHIFT)) * LN2;
+  V2l n = (V2l) shifted - (V2l) Splat (ROUND_SHIFT);
+  V2d p = Splat (EXP_TAYLOR[0]);
+  for (uint32_t k = 1; k < 13; k++)
+    {
+      p = p * f + EXP_TAYLOR[k];
+    }
+  return p * (V2d) ((n + 1023) << 52);
+}
+
+/* log2 x for normal x > 0: the exponent plus 2 atanh ((m-1)/(m+1)) / ln 2
+ * of the mantissa m, taken in [sqrt(1/2), sqrt(2)). */
+static inline V2d
+Log2 (V2d x)
+{
+  V2l bits = (V2l) x;
+  V2l e = ((bits >> 52) & 0x7ff) - 1023;
+  V2d m = (V2d) ((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+  V2l high = m > SQRT2;
+  m = Select (high, m * 0.5, m);
+  e -= high;
+  V2d s = (m - 1) / (m + 1);
+  V2d s2 = s * s;
+  V2d p = Splat (ATANH_TAYLOR[0]);
+  for (uint32_t k = 1; k < 11; k++)
+    {
+      p = p * s2 + ATANH_TAYLOR[k];
+    }
+  V2d exponent = (V2d) (e + (V2l) Splat (ROUND_SHIFT)) - ROUND_SHIFT;
+  return exponent + 2 * LOG2E * s * p;
+}
+
+/* x^y for x >= 0 and y > 0 */
+static inline V2d
+Pow (V2d x, V2d y)
+{
+  return Select (x > 0, Exp2 (y * Log2 (x)), Splat (0));
+}
+
+static inline V2d
+CodingMos (V2d bitrate)
+{
+  V2d ccf = Min (Pow (bitrate / (P1201_ABIF * 15.0), Splat (0.5)), Splat (P1201_CCF_MAX));
+  V2d nbr = bitrate * P1201_NBR;
+  V2d dc = 4 / (1 + Pow (nbr / (P1201_DC[0] * ccf + 1.0), P1201_DC[1] * ccf + P1201_DC[2]));
+  return (5 - dc) * (1 + P1201_MOSC[0] * ccf - P1201_MOSC[1] * ccf * P1201_LOG_FRAME_INTERVAL);
+}
+
+static inline V2d
+BufferMos (V2d length, V2d count)
+{
+  V2d degradation = P1201_BUFFER[0]
+    - P1201_BUFFER[1] * Exp2 (LOG2E * P1201_LOG_E * (-P1201_BUFFER[2] * length - P1201_BUFFER[3]) * count);
+  return 5 - Min (Max (degradation, Splat (0)), Splat (4));
+}
+
+static inline V2d
+IntegrationMos (V2d codingMos, V2d stallMos, V2d overflowMos)
+{
+  V2d bufferMos = P1201_INTEGRATION[0] * stallMos + P1201_INTEGRATION[1] * overflowMos
+    + P1201_INTEGRATION[2] * stallMos * overflowMos + P1201_INTEGRATION[3];
+  return Min (Max (codingMos - 5 + bufferMos, Splat (1)), Splat (5));
+}
+
+/* p[0, lanes), the missing lane repeating p[0] */
+static inline V2d
+Load (const double *p, uint32_t lanes)
+{
+  V2d v = Splat (p[0]);
+  if (lanes == 2)
+    {
+      std::memcpy (&v, p, sizeof (v));
+    }
+  return v;
+}
+
+static inline void
+Store (double *p, V2d v, uint32_t lanes)
+{
+  if (lanes == 2)
+    {
+      std::memcpy (p, &v, sizeof (v));
+    }
+  else
+    {
+      p[0] = v[0];
+    }
+}
+#endif
+
+double
+EvalvidP1201CodingMos (double bitrate)
+{
+  return CodingMos (bitrate);
+}
+
+void
+EvalvidP1201CodingMos (const double *bitrate, double *mos, uint32_t n)
+{
+#if defined (__GNUC__)
+  for (uint32_t i = 0; i < n; i += 2)
+    {
+      uint32_t lanes = std::min<uint32_t> (n - i, 2);
+      Store (mos + i, CodingMos (Load (bitrate + i, lanes)), lanes);
+    }
+#else
+  for (uint32_t i = 0; i < n; i++)
+    {
+      mos[i] = CodingMos (bitrate[i]);
+    }
+#endif
+}
+
+double
+EvalvidP1201Mos (const EvalvidQoeInputs &inputs)
+{
+  return IntegrationMos (inputs.codingMos,
+                         BufferMos (inputs.stallLength, inputs.stalls),
+                         BufferMos (inputs.overflowLength, inputs.overflows));
+}
+
+void
+EvalvidP1201Mos (const double *codingMos, const double *stallLength, const double *stalls,
+                 const double *overflowLength, const double *overflows, double *mos, uint32_t n)
+{
+#if defined (__GNUC__)
+  for (uint32_t i = 0; i < n; i += 2)
+    {
+      uint32_t lanes = std::min<uint32_t> (n - i, 2);
+      V2d stallMos = BufferMos (Load (stallLength + i, lanes), Load (stalls + i, lanes));
+      V2d overflowMos = BufferMos (Load (overflowLength + i, lanes), Load (overflows + i, lanes));
+      Store (mos + i, IntegrationMos (Load (codingMos + i, lanes), stallMos, overflowMos), lanes);
+    }
+#else
+  for (uint32_t i = 0; i < n; i++)
+    {
+      mos[i] = IntegrationMos (codingMos[i],
+                               BufferMos (stallLength[i], stalls[i]),
+                               BufferMos (overflowLength[i], overflows[i]));
+    }
+#endif
+}
+
+void
+EvalvidQoeBatch::Add (const EvalvidQoeInputs &inputs)
+{
+  m_codingMos.push_back (inputs.codingMos);
+  m_stallLength.push_back (inputs.stallLength);
+  m_stalls.push_back (inputs.stalls);
+  m_overflowLength.push_back (inputs.overflowLength);
+  m_overflows.push_back (inputs.overflows);
+}
+
+void
+EvalvidQoeBatch::Clear (void)
+{
+  m_codingMos.clear ();
+  m_stallLength.clear ();
+  m_stalls.clear ();
+  m_overflowLength.clear ();
+  m_overflows.clear ();
+  m_mos.clear ();
+}
+
+uint32_t
+EvalvidQoeBatch::GetN (void) const
+{
+  return m_codingMos.size ();
+}
+
+const std::vector<double> &
+EvalvidQoeBatch::Evaluate (void)
+{
+  m_mos.resize (m_codingMos.size ());
+  if (!m_mos.empty ())
+    {
+      EvalvidP1201Mos (&m_codingMos[0], &m_stallLength[0], &m_stalls[0],
+                       &m_overflowLength[0], &m_overflows[0], &m_mos[0], m_mos.size ());
+    }
+  return m_mos;
+}
+
+EvalvidQoeTimeline::EvalvidQoeTimeline ()
+  : m_started (false),
+    m_time (0),
+    m_bitrate (0),
+    m_codingMos (0),
+    m_stalled (false),
+    m_stallStart (0),
+    m_overflowed (false),
+    m_overflowStart (0)
+{
+  Reset (m_session, 0);
+  Reset (m_window, 0);
+}
+
+void
+EvalvidQoeTimeline::Reset (Period &period, double start)
+{
+  period.start = start;
+  period.playing = 0;
+  period.codingSum = 0;
+  period.stalls = 0;
+  period.stallTime = 0;
+  period.overflows = 0;
+  period.overflowTime = 0;
+  period.frames = 0;
+  period.decodable = 0;
+}
+
+void
+EvalvidQoeTimeline::Start (double time)
+{
+  m_started = true;
+  m_time = time;
+  m_bitrate = 0;
+  m_codingMos = 0;
+  m_stalled = false;
+  m_overflowed = false;
+  Reset (m_session, time);
+  Reset (m_window, time);
+  m_windows.clear ();
+}
+
+void
+EvalvidQoeTimeline::Advance (double time)
+{
+  if (!m_stalled && m_bitrate > 0 && time > m_time)
+    {
+      double played = time - m_time;
+      m_session.playing += played;
+      m_session.codingSum += played * m_codingMos;
+      m_window.playing += played;
+      m_window.codingSum += played * m_codingMos;
+    }
+  m_time = std::max (m_time, time);
+}
+
+void
+EvalvidQoeTimeline::SetBitrate (double time, double bitrate)
+{
+  if (bitrate == m_bitrate)
+    {
+      return;
+    }
+  Advance (time);
+  m_bitrate = bitrate;
+  m_codingMos = CodingMos (bitrate);
+}
+
+void
+EvalvidQoeTimeline::StallStart (double time)
+{
+  if (m_stalled)
+    {
+      return;
+    }
+  Advance (time);
+  m_stalled = true;
+  m_stallStart = time;
+  m_session.stalls++;
+  m_window.stalls++;
+}
+
+void
+EvalvidQoeTimeline::StallEnd (double time)
+{
+  if (!m_stalled)
+    {
+      return;
+    }
+  Advance (time);
+  m_stalled = false;
+  m_session.stallTime += time - std::max (m_stallStart, m_session.start);
+  m_window.stallTime += time - std::max (m_stallStart, m_window.start);
+}
+
+void
+EvalvidQoeTimeline::OverflowStart (double time)
+{
+  if (m_overflowed)
+    {
+      return;
+    }
+  m_overflowed = true;
+  m_overflowStart = time;
+  m_session.overflows++;
+  m_window.overflows++;
+}
+
+void
+EvalvidQoeTimeline::OverflowEnd (double time)
+{
+  if (!m_overflowed)
+    {
+      return;
+    }
+  m_overflowed = false;
+  m_session.overflowTime += time - std::max (m_overflowStart, m_session.start);
+  m_window.overflowTime += time - std::max (m_overflowStart, m_window.start);
+}
+
+void
+EvalvidQoeTimeline::NotifyFrame (bool decodable)
+{
+  m_session.frames++;
+  m_window.frames++;
+  if (decodable)
+    {
+      m_session.decodable++;
+      m_window.decodable++;
+    }
+}
+
+EvalvidQoeInputs
+EvalvidQoeTimeline::GetInputs (const Period &period, double time) const
+{
+  EvalvidQoeInputs inputs;
+  inputs.codingMos = period.playing > 0 ? period.codingSum / period.playing : m_codingMos;
+  if (period.frames > 0)
+    {
+      inputs.codingMos = 1 + (inputs.codingMos - 1) * period.decodable / period.frames;
+    }
+  double stallTime = period.stallTime;
+  if (m_stalled)
+    {
+      stallTime += time - std::max (m_stallStart, period.start);
+    }
+  double overflowTime = period.overflowTime;
+  if (m_overflowed)
+    {
+      overflowTime += time - std::max (m_overflowStart, period.start);
+    }
+  inputs.stalls = period.stalls;
+  inputs.stallLength = period.stalls > 0 ? stallTime / period.stalls : 0;
+  inputs.overflows = period.overflows;
+  inputs.overflowLength = period.overflows > 0 ? overflowTime / period.overflows : 0;
+  return inputs;
+}
+
+double
+EvalvidQoeTimeline::EndWindow (double time)
+{
+  Advance (time);
+  double mos = EvalvidP1201Mos (GetInputs (m_window, time));
+  m_windows.push_back (std::make_pair (time, mos));
+  Reset (m_window, time);
+  // What is still going on counts in the next window too.
+  m_window.stalls = m_stalled ? 1 : 0;
+  m_window.overflows = m_overflowed ? 1 : 0;
+  return mos;
+}
+
+double
+EvalvidQoeTimeline::Finish (double time)
+{
+  StallEnd (time);
+  OverflowEnd (time);
+  Advance (time);
+  return GetSessionMos ();
+}
+
+bool
+EvalvidQoeTimeline::IsStarted (void) const
+{
+  return m_started;
+}
+
+EvalvidQoeInputs
+EvalvidQoeTimeline::GetSessionInputs (void) const
+{
+  return GetInputs (m_session, m_time);
+}
+
+double
+EvalvidQoeTimeline::GetSessionMos (void) const
+{
+  return EvalvidP1201Mos (GetSessionInputs ());
+}
+
+const std::vector<std::pair<double, double> > &
+EvalvidQoeTimeline::GetWindows (void) const
+{
+  return m_windows;
+}
+
+} // namespace ns3
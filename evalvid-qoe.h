@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_QOE_H__
+#define __EVALVID_QOE_H__
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief Inputs of the ITU-T P.1201 integration (O.41) for one period.
+ */
+struct EvalvidQoeInputs
+{
+  double   codingMos;       //!< Audiovisual coding quality O.32, from EvalvidP1201CodingMos.
+  double   stallLength;     //!< Mean interruption duration L (s).
+  uint32_t stalls;          //!< Number of interruptions N.
+  double   overflowLength;  //!< Mean overflow duration T (s).
+  uint32_t overflows;       //!< Number of overflows M.
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief ITU-T P.1201 coding quality of a video bitrate
+ * \param bitrate video bitrate (kbit/s)
+ * \returns O.23, which is also O.32 as there is no audio
+ */
+double EvalvidP1201CodingMos (double bitrate);
+
+/**
+ * \ingroup Evalvid
+ * \brief EvalvidP1201CodingMos of n bitrates
+ *
+ * Evaluated with SIMD instructions like the array EvalvidP1201Mos.
+ *
+ * \param bitrate the bitrates (kbit/s)
+ * \param mos receives the coding qualities; may be bitrate
+ * \param n number of bitrates
+ */
+void EvalvidP1201CodingMos (const double *bitrate, double *mos, uint32_t n);
+
+/**
+ * \ingroup Evalvid
+ * \brief ITU-T P.1201 quality of a period
+ * \param inputs the coding quality, interruptions and overflows of the period
+ * \returns the MOS O.41, between 1 and 5
+ */
+double EvalvidP1201Mos (const EvalvidQoeInputs &inputs);
+
+/**
+ * \ingroup Evalvid
+ * \brief EvalvidP1201Mos of n periods, as one array per input
+ *
+ * Evaluated two periods at a time with SIMD instructions under the default
+ * compiler flags, -ffast-math not needed; the MOS agree with the scalar
+ * EvalvidP1201Mos to about 1e-14. Counts are given as doubles so that they
+ * load into the same vectors.
+ *
+ * \param codingMos the coding qualities O.32
+ * \param stallLength the mean interruption durations (s)
+ * \param stalls the interruption counts
+ * \param overflowLength the mean overflow durations (s)
+ * \param overflows the overflow counts
+ * \param mos receives the MOS of each period; may be any of the inputs
+ * \param n number of periods
+ */
+void EvalvidP1201Mos (const double *codingMos, const double *stallLength, const double *stalls,
+                      const double *overflowLength, const double *overflows, double *mos, uint32_t n);
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidQoeBatch
+ * \brief Inputs of many sessions, evaluated with one call of the SIMD EvalvidP1201Mos.
+ */
+class EvalvidQoeBatch
+{
+public:
+  void Add (const EvalvidQoeInputs &inputs);
+  void Clear (void);
+  uint32_t GetN (void) const;
+  /// \returns the MOS of the sessions, in the order they were added
+  const std::vector<double> &Evaluate (void);
+
+private:
+  std::vector<double> m_codingMos;
+  std::vector<double> m_stallLength;
+  std::vector<double> m_stalls;
+  std::vector<double> m_overflowLength;
+  std::vector<double> m_overflows;
+  std::vector<double> m_mos;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidQoeTimeline
+ * \brief Incremental ITU-T P.1201 quality of a playback session.
+ *
+ * The client reports chunk bitrate changes and the start and end of
+ * interruptions and overflows as they happen. The coding quality of a
+ * bitrate is computed once, when its chunk starts, and integrated over
+ * the playing time; interruptions and overflows are counted and timed.
+ * The coding quality is scaled by the share of played frames that were
+ * decodable, 1 + (O.23 - 1) * decodable / played: the P.1201 mode used here
+ * does not model packet loss, so undecodable frames degrade the picture
+ * towards the bottom of the scale in proportion to their share.
+ * EndWindow closes a window of the time series with the MOS of that
+ * window alone, Finish the session with the MOS of the whole session, so
+ * the model is only evaluated once per window. An interruption or overflow
+ * spanning windows counts in each of them, for the time it lasts there.
+ */
+class EvalvidQoeTimeline
+{
+public:
+  EvalvidQoeTimeline ();
+
+  /// Start the session and its first window at time (s).
+  void Start (double time);
+  /// Play the chunks from time on at bitrate (kbit/s).
+  void SetBitrate (double time, double bitrate);
+  void StallStart (double time);
+  void StallEnd (double time);
+  void OverflowStart (double time);
+  void OverflowEnd (double time);
+  /// Count a played frame, H frames excepted.
+  void NotifyFrame (bool decodable);
+
+  /**
+   * \brief close the current window at time and start the next one
+   * \returns the MOS of the window
+   */
+  double EndWindow (double time);
+  /**
+   * \brief close the session at time; open interruptions and overflows end there
+   * \returns the MOS of the session
+   */
+  double Finish (double time);
+
+  bool IsStarted (void) const;
+  /// \returns the inputs of the session so far, e.g. for an EvalvidQoeBatch
+  EvalvidQoeInputs GetSessionInputs (void) const;
+  /// \returns the MOS of the session so far
+  double GetSessionMos (void) const;
+  /// \returns the end time (s) and MOS of every closed window
+  const std::vector<std::pair<double, double> > &GetWindows (void) const;
+
+private:
+  /// Period the inputs of the session or of a window are accumulated over.
+  struct Period
+  {
+    double   start;
+    double   playing;       //!< Time played (s).
+    double   codingSum;     //!< Coding quality integrated over the time played.
+    uint32_t stalls;
+    double   stallTime;
+    uint32_t overflows;
+    double   overflowTime;
+    uint32_t frames;        //!< Frames played.
+    uint32_t decodable;     //!< Frames played decodable.
+  };
+
+  static void Reset (Period &period, double start);
+  /// Integrate the coding quality up to time.
+  void Advance (double time);
+  EvalvidQoeInputs GetInputs (const Period &period, double time) const;
+
+  bool m_started;
+  double m_time;           //!< Time the coding quality is integrated up to.
+  double m_bitrate;
+  double m_codingMos;      //!< Coding quality of m_bitrate.
+  bool m_stalled;
+  double m_stallStart;
+  bool m_overflowed;
+  double m_overflowStart;
+  Period m_session;
+  Period m_window;
+  std::vector<std::pair<double, double> > m_windows;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_QOE_H__
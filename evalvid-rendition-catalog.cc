@@ -0,0 +1,536 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/callback.h"
+#include "ns3/system-thread.h"
+
+#include "evalvid-rendition-catalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidRenditionCatalog");
+
+static_assert (sizeof (EvalvidTraceFrame) == 32, "EvalvidTraceFrame must stay packed");
+
+EvalvidRendition::EvalvidRendition ()
+  : m_mapping (0),
+    m_mappingSize (0),
+    m_frames (0),
+    m_nFrames (0),
+    m_firstFrameId (0),
+    m_bitrate (0)
+{
+}
+
+EvalvidRendition::~EvalvidRendition ()
+{
+  if (m_mapping != 0)
+    {
+      munmap (m_mapping, m_mappingSize);
+    }
+}
+
+const std::string &
+EvalvidRendition::GetFileName (void) const
+{
+  return m_fileName;
+}
+
+void
+EvalvidRendition::SetFileName (const std::string &fileName)
+{
+  m_fileName = fileName;
+}
+
+const EvalvidTraceFrame *
+EvalvidRendition::GetFrames (void) const
+{
+  return m_frames;
+}
+
+uint32_t
+EvalvidRendition::GetNFrames (void) const
+{
+  return m_nFrames;
+}
+
+bool
+EvalvidRendition::IsEmpty (void) const
+{
+  return m_nFrames == 0;
+}
+
+uint32_t
+EvalvidRendition::GetFrameIndex (uint32_t frameId) const
+{
+  if (frameId < m_firstFrameId || frameId - m_firstFrameId >= m_frameIndex.size ())
+    {
+      return m_nFrames;
+    }
+  return m_frameIndex[frameId - m_firstFrameId];
+}
+
+void
+EvalvidRendition::AddFrame (uint32_t frameId, EvalvidFrameTag::FrameType frameType, uint32_t frameSize,
+                            uint16_t numOfUdpPackets, uint64_t sendTime)
+{
+  EvalvidTraceFrame frame;
+  frame.sendTime = sendTime;
+  frame.byteOffset = 0;
+  frame.packetInterval = sendTime;
+  if (!m_storage.empty ())
+    {
+      const EvalvidTraceFrame &last = m_storage.back ();
+      frame.byteOffset = last.byteOffset + last.frameSize;
+      frame.packetInterval = sendTime > last.sendTime ? sendTime - last.sendTime : 0;
+    }
+  frame.frameId = frameId;
+  frame.frameSize = frameSize;
+  frame.numOfUdpPackets = numOfUdpPackets;
+  frame.frameType = frameType;
+  frame.reserved = 0;
+  m_storage.push_back (frame);
+}
+
+bool
+EvalvidRendition::MapBinaryTrace (const std::string &fileName)
+{
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || (size_t) st.st_size < sizeof (EvalvidTraceFileHeader))
+    {
+      close (fd);
+      return false;
+    }
+  void *mapping = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    {
+      return false;
+    }
+
+  const EvalvidTraceFileHeader *header = static_cast<const EvalvidTraceFileHeader *> (mapping);
+  if (header->magic != EvalvidTraceFileHeader::MAGIC
+      || header->version != EvalvidTraceFileHeader::VERSION
+      || header->recordSize != sizeof (EvalvidTraceFrame)
+      || (size_t) st.st_size < sizeof (EvalvidTraceFileHeader) + (size_t) header->nFrames * sizeof (EvalvidTraceFrame))
+    {
+      munmap (mapping, st.st_size);
+      return false;
+    }
+
+  m_storage.clear ();
+  m_mapping = mapping;
+  m_mappingSize = st.st_size;
+  m_frames = reinterpret_cast<const EvalvidTraceFrame *> (header + 1);
+  m_nFrames = header->nFrames;
+  return true;
+}
+
+void
+EvalvidRendition::Seal (void)
+{
+  if (m_mapping == 0)
+    {
+      m_frames = m_storage.empty () ? 0 : &m_storage[0];
+      m_nFrames = m_storage.size ();
+    }
+  m_frameIndex.clear ();
+  m_chunks.clear ();
+  m_frameChunk.clear ();
+  m_bitrate = 0;
+  if (m_nFrames == 0)
+    {
+      return;
+    }
+
+  uint32_t minId = m_frames[0].frameId;
+  uint32_t maxId = m_frames[0].frameId;
+  for (uint32_t i = 1; i < m_nFrames; i++)
+    {
+      minId = std::min (minId, m_frames[i].frameId);
+      maxId = std::max (maxId, m_frames[i].frameId);
+    }
+  m_firstFrameId = minId;
+  m_frameIndex.assign (maxId - minId + 1, m_nFrames);
+  for (uint32_t i = 0; i < m_nFrames; i++)
+    {
+      m_frameIndex[m_frames[i].frameId - minId] = i;
+    }
+
+  m_frameChunk.resize (m_nFrames);
+  uint32_t hFrames = 0;
+  for (uint32_t i = 0; i < m_nFrames; i++)
+    {
+      const EvalvidTraceFrame &frame = m_frames[i];
+      bool boundary = false;
+      if (frame.GetFrameType () == EvalvidFrameTag::H_FRAME && frame.packetInterval != 0)
+        {
+          boundary = hFrames % 3 == 0;
+          hFrames++;
+        }
+      if (m_chunks.empty () || (boundary && m_chunks.back ().firstFrame != i))
+        {
+          EvalvidChunk chunk;
+          chunk.firstFrame = i;
+          chunk.nFrames = 0;
+          chunk.bytes = 0;
+          chunk.duration = 0;
+          chunk.bitrate = 0;
+          m_chunks.push_back (chunk);
+        }
+      EvalvidChunk &chunk = m_chunks.back ();
+      chunk.nFrames++;
+      chunk.bytes += frame.frameSize;
+      chunk.duration += frame.packetInterval;
+      m_frameChunk[i] = m_chunks.size () - 1;
+    }
+  uint64_t bytes = 0;
+  uint64_t duration = 0;
+  for (uint32_t i = 0; i < m_chunks.size (); i++)
+    {
+      EvalvidChunk &chunk = m_chunks[i];
+      bytes += chunk.bytes;
+      duration += chunk.duration;
+      if (chunk.duration > 0)
+        {
+          chunk.bitrate = chunk.bytes * 8 / (chunk.duration / 1e6 * 1024);
+        }
+    }
+  if (duration > 0)
+    {
+      m_bitrate = bytes * 8 * 1000.0 / duration;
+    }
+}
+
+double
+EvalvidRendition::GetBitrate (void) const
+{
+  return m_bitrate;
+}
+
+void
+EvalvidRendition::Derive (const EvalvidRendition &master, double bitrate, const EvalvidRateModel &model)
+{
+  NS_ASSERT (m_nFrames == 0 && m_storage.empty ());
+  double ratio = master.GetBitrate () > 0 ? bitrate / master.GetBitrate () : 1;
+  double exponent[EvalvidFrameTag::B_FRAME + 1] = { 1, 0, model.iExponent, model.pExponent, model.bExponent };
+
+  // Bytes of the frames that keep their size, and weights of the others.
+  uint64_t duration = 0;
+  double fixedBytes = 0;
+  double weights = 0;
+  for (uint32_t i = 0; i < master.GetNFrames (); i++)
+    {
+      const EvalvidTraceFrame &frame = master.GetFrame (i);
+      duration += frame.packetInterval;
+      if (frame.GetFrameType () == EvalvidFrameTag::H_FRAME)
+        {
+          fixedBytes += frame.frameSize;
+        }
+      else
+        {
+          weights += frame.frameSize * std::pow (ratio, exponent[frame.frameType]);
+        }
+    }
+  double targetBytes = master.GetBitrate () > 0 ? bitrate * duration / 8000 : fixedBytes + weights;
+  double c = weights > 0 ? std::max (targetBytes - fixedBytes, 0.0) / weights : 0;
+
+  m_storage.reserve (master.GetNFrames ());
+  for (uint32_t i = 0; i < master.GetNFrames (); i++)
+    {
+      const EvalvidTraceFrame &frame = master.GetFrame (i);
+      uint32_t frameSize = frame.frameSize;
+      uint16_t numOfUdpPackets = frame.numOfUdpPackets;
+      if (frame.GetFrameType () != EvalvidFrameTag::H_FRAME)
+        {
+          frameSize = std::max<uint32_t> (1, llround (frame.frameSize * c * std::pow (ratio, exponent[frame.frameType])));
+          // EvalvidServer sends frameSize / payload full fragments and the rest.
+          numOfUdpPackets = frameSize / model.packetPayload + 1;
+        }
+      AddFrame (frame.frameId, frame.GetFrameType (), frameSize, numOfUdpPackets, frame.sendTime);
+    }
+  Seal ();
+}
+
+bool
+EvalvidRateModel::operator< (const EvalvidRateModel &other) const
+{
+  if (iExponent != other.iExponent)
+    {
+      return iExponent < other.iExponent;
+    }
+  if (pExponent != other.pExponent)
+    {
+      return pExponent < other.pExponent;
+    }
+  if (bExponent != other.bExponent)
+    {
+      return bExponent < other.bExponent;
+    }
+  return packetPayload < other.packetPayload;
+}
+
+bool
+EvalvidRenditionCatalog::DerivedKey::operator< (const DerivedKey &other) const
+{
+  if (master != other.master)
+    {
+      return master < other.master;
+    }
+  if (bitrate != other.bitrate)
+    {
+      return bitrate < other.bitrate;
+    }
+  return model < other.model;
+}
+
+uint32_t
+EvalvidRendition::GetNChunks (void) const
+{
+  return m_chunks.size ();
+}
+
+const EvalvidChunk &
+EvalvidRendition::GetChunk (uint32_t index) const
+{
+  NS_ASSERT (index < m_chunks.size ());
+  return m_chunks[index];
+}
+
+Ptr<const EvalvidRenditionCatalog>
+EvalvidRenditionCatalog::Get (const std::vector<std::string> &fileNames)
+{
+  static std::map<std::vector<std::string>, Ptr<const EvalvidRenditionCatalog> > catalogs;
+
+  std::map<std::vector<std::string>, Ptr<const EvalvidRenditionCatalog> >::iterator it = catalogs.find (fileNames);
+  if (it != catalogs.end ())
+    {
+      return it->second;
+    }
+  Ptr<const EvalvidRenditionCatalog> catalog (new EvalvidRenditionCatalog (fileNames), false);
+  catalogs.insert (std::make_pair (fileNames, catalog));
+  return catalog;
+}
+
+EvalvidRenditionCatalog::EvalvidRenditionCatalog (const std::vector<std::string> &fileNames)
+  : m_renditions (fileNames.size ())
+{
+  NS_LOG_FUNCTION (this);
+
+  for (uint32_t i = 0; i < fileNames.size (); i++)
+    {
+      m_renditions[i].SetFileName (fileNames[i]);
+      m_index.insert (std::make_pair (fileNames[i], i));
+    }
+
+  if (m_renditions.size () == 1)
+    {
+      LoadRendition (&m_renditions[0]);
+    }
+  else
+    {
+      std::vector<Ptr<SystemThread> > loaders;
+      for (uint32_t i = 0; i < m_renditions.size (); i++)
+        {
+          Ptr<SystemThread> loader = Create<SystemThread> (MakeBoundCallback (&EvalvidRenditionCatalog::LoadRendition,
+                                                                              &m_renditions[i]));
+          loader->Start ();
+          loaders.push_back (loader);
+        }
+      for (uint32_t i = 0; i < loaders.size (); i++)
+        {
+          loaders[i]->Join ();
+        }
+    }
+
+  for (uint32_t i = 0; i < m_renditions.size (); i++)
+    {
+      if (m_renditions[i].IsEmpty ())
+        {
+          NS_LOG_WARN (">> EvalvidRenditionCatalog: No frames read from video trace file: " << m_renditions[i].GetFileName ());
+        }
+      else
+        {
+          NS_LOG_INFO (">> EvalvidRenditionCatalog: " << m_renditions[i].GetFileName () << ": "
+                       << m_renditions[i].GetNFrames () << " frames");
+        }
+    }
+}
+
+void
+EvalvidRenditionCatalog::LoadRendition (EvalvidRendition *rendition)
+{
+  const std::string &fileName = rendition->GetFileName ();
+  std::string binaryFileName = GetBinaryFileName (fileName);
+  struct stat textStat;
+  struct stat binaryStat;
+  if (stat (binaryFileName.c_str (), &binaryStat) == 0
+      && (stat (fileName.c_str (), &textStat) != 0 || binaryStat.st_mtime >= textStat.st_mtime)
+      && rendition->MapBinaryTrace (binaryFileName))
+    {
+      rendition->Seal ();
+      return;
+    }
+  ParseTextTrace (fileName, rendition);
+  rendition->Seal ();
+}
+
+void
+EvalvidRenditionCatalog::ParseTextTrace (const std::string &fileName, EvalvidRendition *rendition)
+{
+  uint32_t frameId;
+  std::string frameType;
+  uint32_t frameSize;
+  uint16_t numOfUdpPackets;
+  double sendTime;
+
+  //Open file from mp4trace tool of EvalVid.
+  std::ifstream videoTraceFile (fileName.c_str (), std::ios::in);
+  if (videoTraceFile.fail ())
+    {
+      return;
+    }
+
+  while (videoTraceFile >> frameId >> frameType >> frameSize >> numOfUdpPackets >> sendTime)
+    {
+      rendition->AddFrame (frameId, EvalvidFrameTag::GetFrameTypeFromString (frameType),
+                           frameSize, numOfUdpPackets, (uint64_t) llround (sendTime * 1e6));
+    }
+}
+
+bool
+EvalvidRenditionCatalog::ConvertTextTrace (const std::string &textFileName, const std::string &binaryFileName)
+{
+  EvalvidRendition rendition;
+  ParseTextTrace (textFileName, &rendition);
+  rendition.Seal ();
+  if (rendition.IsEmpty ())
+    {
+      NS_LOG_WARN (">> EvalvidRenditionCatalog: No frames read from video trace file: " << textFileName);
+      return false;
+    }
+
+  EvalvidTraceFileHeader header;
+  memset (&header, 0, sizeof (header));
+  header.magic = EvalvidTraceFileHeader::MAGIC;
+  header.version = EvalvidTraceFileHeader::VERSION;
+  header.recordSize = sizeof (EvalvidTraceFrame);
+  header.nFrames = rendition.GetNFrames ();
+
+  // Write to a temporary file and rename it, so that a simulation never
+  // maps a partially written trace.
+  std::string tmpFileName = binaryFileName + ".tmp";
+  std::ofstream binaryFile (tmpFileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  binaryFile.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  binaryFile.write (reinterpret_cast<const char *> (rendition.GetFrames ()),
+                    (std::streamsize) rendition.GetNFrames () * sizeof (EvalvidTraceFrame));
+  binaryFile.close ();
+  if (binaryFile.fail () || rename (tmpFileName.c_str (), binaryFileName.c_str ()) != 0)
+    {
+      NS_LOG_WARN (">> EvalvidRenditionCatalog: Error while writing binary trace file: " << binaryFileName);
+      remove (tmpFileName.c_str ());
+      return false;
+    }
+  NS_LOG_INFO (">> EvalvidRenditionCatalog: " << textFileName << " -> " << binaryFileName << ": "
+               << rendition.GetNFrames () << " frames");
+  return true;
+}
+
+std::string
+EvalvidRenditionCatalog::GetBinaryFileName (const std::string &fileName)
+{
+  return fileName + ".evtb";
+}
+
+uint32_t
+EvalvidRenditionCatalog::GetNRenditions (void) const
+{
+  return m_renditions.size () + m_derived.size ();
+}
+
+const EvalvidRendition &
+EvalvidRenditionCatalog::GetRendition (uint32_t index) const
+{
+  if (index < m_renditions.size ())
+    {
+      return m_renditions[index];
+    }
+  NS_ASSERT (index - m_renditions.size () < m_derived.size ());
+  return m_derived[index - m_renditions.size ()];
+}
+
+uint32_t
+EvalvidRenditionCatalog::GetIndex (const std::string &fileName) const
+{
+  std::unordered_map<std::string, uint32_t>::const_iterator it = m_index.find (fileName);
+  if (it == m_index.end ())
+    {
+      return GetNRenditions ();
+    }
+  return it->second;
+}
+
+uint32_t
+EvalvidRenditionCatalog::GetDerivedIndex (uint32_t master, double bitrate, const EvalvidRateModel &model) const
+{
+  NS_ASSERT (master < m_renditions.size ());
+  DerivedKey key;
+  key.master = master;
+  key.bitrate = bitrate;
+  key.model = model;
+  std::map<DerivedKey, uint32_t>::const_iterator it = m_derivedIndex.find (key);
+  if (it != m_derivedIndex.end ())
+    {
+      return it->second;
+    }
+
+  m_derived.emplace_back ();
+  EvalvidRendition &rendition = m_derived.back ();
+  std::ostringstream fileName;
+  fileName << m_renditions[master].GetFileName () << "@" << bitrate << "k";
+  rendition.SetFileName (fileName.str ());
+  rendition.Derive (m_renditions[master], bitrate, model);
+
+  uint32_t index = m_renditions.size () + m_derived.size () - 1;
+  m_derivedIndex.insert (std::make_pair (key, index));
+  NS_LOG_INFO (">> EvalvidRenditionCatalog: " << rendition.GetFileName () << ": "
+               << rendition.GetNFrames () << " frames, " << rendition.GetBitrate () << " kbit/s");
+  return index;
+}
+
+} // namespace ns3
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_RENDITION_CATALOG_H__
+#define __EVALVID_RENDITION_CATALOG_H__
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "evalvid-frame-tag.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \brief One frame of an mp4trace file, packed in 32 bytes.
+ *
+ * Times are integer microseconds, so that records can be compared and
+ * stored without rounding. The layout has no padding and only fixed width
+ * fields.
+ */
+struct EvalvidTraceFrame
+{
+  uint64_t sendTime;         //!< Microseconds since the first frame.
+  uint64_t byteOffset;       //!< Bytes of all the frames before this one.
+  uint32_t frameId;
+  uint32_t frameSize;
+  uint32_t packetInterval;   //!< Microseconds since the previous frame.
+  uint16_t numOfUdpPackets;
+  uint8_t  frameType;        //!< An EvalvidFrameTag::FrameType.
+  uint8_t  reserved;
+
+  EvalvidFrameTag::FrameType GetFrameType (void) const
+  {
+    return static_cast<EvalvidFrameTag::FrameType> (frameType);
+  }
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief One chunk (segment) of a rendition.
+ *
+ * A chunk starts at every third H frame that has a non zero interval; the
+ * frames before the first such H frame form chunk 0. The duration sums the
+ * intervals of the frames of the chunk, as EvalvidServer accounts them when
+ * it sends the frames.
+ */
+struct EvalvidChunk
+{
+  uint32_t firstFrame;  //!< Index of the first frame of the chunk.
+  uint32_t nFrames;
+  uint64_t bytes;
+  uint64_t duration;    //!< Microseconds.
+  double   bitrate;     //!< bytes * 8 / (duration * 1024), 0 for an empty duration.
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief Scaling of the frame sizes of a rendition to another bitrate.
+ *
+ * For a bitrate ratio r between the derived and the master rendition, a
+ * frame of type t is scaled by c r^e_t, with c such that the derived
+ * rendition has the requested mean bitrate. Exponents below 1 give the
+ * type a larger share of the bytes at low bitrates. H frames are headers
+ * and keep their size.
+ */
+struct EvalvidRateModel
+{
+  double   iExponent;
+  double   pExponent;
+  double   bExponent;
+  uint16_t packetPayload;  //!< Fragment size, to count the packets of a frame.
+
+  bool operator< (const EvalvidRateModel &other) const;
+};
+
+/**
+ * \ingroup Evalvid
+ * \brief Header of a binary trace file, followed by nFrames EvalvidTraceFrame.
+ *
+ * Binary traces are written in host byte order by
+ * EvalvidRenditionCatalog::ConvertTextTrace; a file written on a host of the
+ * other byte order fails the magic check and the text trace is used instead.
+ */
+struct EvalvidTraceFileHeader
+{
+  static const uint32_t MAGIC = 0x45565442;  //!< "EVTB"
+  static const uint16_t VERSION = 1;
+
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;       //!< sizeof (EvalvidTraceFrame) of the writer.
+  uint32_t nFrames;
+  uint32_t reserved[5];
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidRendition
+ * \brief All frames of one encoding (rendition) of the video.
+ *
+ * Frames are a contiguous array in trace order, accessed by index. A frame
+ * id is mapped to its index through a dense table, so seeking is constant
+ * time. The array is either built from a text trace or a read-only mapping
+ * of a binary trace file. Seal also builds the chunk index of the rendition.
+ */
+class EvalvidRendition
+{
+public:
+  EvalvidRendition ();
+  ~EvalvidRendition ();
+
+  const std::string &GetFileName (void) const;
+  void SetFileName (const std::string &fileName);
+
+  /// \returns the frames, GetNFrames () of them
+  const EvalvidTraceFrame *GetFrames (void) const;
+  /// \returns the number of frames, 0 if the file could not be read
+  uint32_t GetNFrames (void) const;
+  bool IsEmpty (void) const;
+  /// \returns the mean bitrate of the rendition (kbit/s), 0 if its duration is 0
+  double GetBitrate (void) const;
+
+  /// \param index index of the frame, lower than GetNFrames ()
+  const EvalvidTraceFrame &GetFrame (uint32_t index) const
+  {
+    return m_frames[index];
+  }
+
+  /**
+   * \param frameId id of a frame
+   * \returns the index of the frame, GetNFrames () if there is no such frame
+   */
+  uint32_t GetFrameIndex (uint32_t frameId) const;
+
+  uint32_t GetNChunks (void) const;
+  /// \param index index of the chunk, lower than GetNChunks ()
+  const EvalvidChunk &GetChunk (uint32_t index) const;
+  /// \param frameIndex index of a frame, lower than GetNFrames ()
+  /// \returns the index of the chunk holding the frame
+  uint32_t GetChunkOfFrame (uint32_t frameIndex) const
+  {
+    return m_frameChunk[frameIndex];
+  }
+  /// \param frameIndex index of a frame, lower than GetNFrames ()
+  /// \returns true if the frame is the first of its chunk
+  bool IsChunkStart (uint32_t frameIndex) const
+  {
+    return m_chunks[m_frameChunk[frameIndex]].firstFrame == frameIndex;
+  }
+
+  /**
+   * \brief append a frame; offsets and interval are computed here
+   * \param frameId id of the frame
+   * \param frameType type of the frame
+   * \param frameSize size of the frame in bytes
+   * \param numOfUdpPackets number of fragments of the frame
+   * \param sendTime microseconds since the first frame
+   */
+  void AddFrame (uint32_t frameId, EvalvidFrameTag::FrameType frameType, uint32_t frameSize,
+                 uint16_t numOfUdpPackets, uint64_t sendTime);
+
+  /**
+   * \brief use the frames of a binary trace file, mapped in memory
+   * \param fileName the binary trace file
+   * \returns false if the file does not exist or is not a valid binary trace
+   */
+  bool MapBinaryTrace (const std::string &fileName);
+
+  /**
+   * \brief fill an empty rendition with the frames of master scaled to bitrate
+   * \param master a sealed rendition
+   * \param bitrate mean bitrate of this rendition (kbit/s)
+   * \param model how the frame sizes are scaled
+   */
+  void Derive (const EvalvidRendition &master, double bitrate, const EvalvidRateModel &model);
+
+  /// Build the frame id table and the chunk index; call once all the frames are added or mapped.
+  void Seal (void);
+
+private:
+  EvalvidRendition (const EvalvidRendition &);
+  EvalvidRendition &operator= (const EvalvidRendition &);
+
+  std::string m_fileName;
+  std::vector<EvalvidTraceFrame> m_storage;
+  void *m_mapping;        // Mapped binary trace file, if any
+  size_t m_mappingSize;
+  const EvalvidTraceFrame *m_frames;
+  uint32_t m_nFrames;
+  uint32_t m_firstFrameId;
+  double m_bitrate;
+  std::vector<uint32_t> m_frameIndex;  // Frame id - m_firstFrameId to frame index
+  std::vector<EvalvidChunk> m_chunks;
+  std::vector<uint32_t> m_frameChunk;  // Frame index to chunk index
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidRenditionCatalog
+ * \brief Immutable set of renditions shared by every EvalvidServer.
+ *
+ * Each distinct list of trace files is loaded once per process, one thread
+ * per file, and every server asking for the same list gets the same
+ * catalog. Servers switch rendition by index, so a switch does not touch
+ * the file system.
+ *
+ * For a trace file "name", a binary trace "name.evtb" at least as recent is
+ * memory-mapped instead of parsing the text, so its pages are shared by all
+ * the simulations using it.
+ *
+ * Renditions derived from a loaded one by GetDerivedIndex are built on
+ * first use and kept with the catalog; they are indexed after the loaded
+ * renditions. Derivation is not thread safe: it is meant to be called from
+ * the simulation only.
+ */
+class EvalvidRenditionCatalog : public SimpleRefCount<EvalvidRenditionCatalog>
+{
+public:
+  /**
+   * \param fileNames the mp4trace files of the renditions, in index order
+   * \returns the shared catalog of these files, loaded on first use
+   */
+  static Ptr<const EvalvidRenditionCatalog> Get (const std::vector<std::string> &fileNames);
+
+  uint32_t GetNRenditions (void) const;
+
+  /// \param index index of the rendition, lower than GetNRenditions ()
+  const EvalvidRendition &GetRendition (uint32_t index) const;
+
+  /**
+   * \param fileName trace file of a rendition
+   * \returns the index of the rendition, GetNRenditions () if it is not in the catalog
+   */
+  uint32_t GetIndex (const std::string &fileName) const;
+
+  /**
+   * \param master index of a loaded rendition
+   * \param bitrate bitrate of the derived rendition (kbit/s)
+   * \param model how the frame sizes are scaled
+   * \returns the index of the rendition derived from master, derived now if it is not yet
+   */
+  uint32_t GetDerivedIndex (uint32_t master, double bitrate, const EvalvidRateModel &model) const;
+
+  /**
+   * \brief convert an mp4trace text file to the binary trace format
+   * \param textFileName the text trace
+   * \param binaryFileName the binary trace to write
+   * \returns false if the text trace cannot be read or the binary one written
+   */
+  static bool ConvertTextTrace (const std::string &textFileName, const std::string &binaryFileName);
+
+  /// \returns the binary trace loaded instead of the text trace fileName, if it is newer
+  static std::string GetBinaryFileName (const std::string &fileName);
+
+private:
+  explicit EvalvidRenditionCatalog (const std::vector<std::string> &fileNames);
+
+  /// Map or parse one trace file; runs in a loader thread.
+  static void LoadRendition (EvalvidRendition *rendition);
+  /// Parse one text trace file into rendition.
+  static void ParseTextTrace (const std::string &fileName, EvalvidRendition *rendition);
+
+  /// Master index, bitrate and model of a derived rendition.
+  struct DerivedKey
+  {
+    uint32_t master;
+    double bitrate;
+    EvalvidRateModel model;
+
+    bool operator< (const DerivedKey &other) const;
+  };
+
+  std::vector<EvalvidRendition> m_renditions;
+  std::unordered_map<std::string, uint32_t> m_index;
+  mutable std::deque<EvalvidRendition> m_derived;  // References stay valid as it grows
+  mutable std::map<DerivedKey, uint32_t> m_derivedIndex;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_RENDITION_CATALOG_H__
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "ns3/log.h"
+
+#include "evalvid-request-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidRequestHeader");
+NS_OBJECT_ENSURE_REGISTERED (EvalvidRequestHeader);
+
+TypeId
+EvalvidRequestHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidRequestHeader")
+    .SetParent<Header> ()
+    .AddConstructor<EvalvidRequestHeader> ()
+    ;
+  return tid;
+}
+
+TypeId
+EvalvidRequestHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+EvalvidRequestHeader::EvalvidRequestHeader ()
+  : m_magic (MAGIC),
+    m_cellId (0),
+    m_rnti (0),
+    m_lcid (0),
+    m_flags (0),
+    m_clientId (0)
+{
+}
+
+uint32_t
+EvalvidRequestHeader::GetSerializedSize (void) const
+{
+  return 14;
+}
+
+void
+EvalvidRequestHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_magic);
+  i.WriteHtonU16 (m_cellId);
+  i.WriteHtonU16 (m_rnti);
+  i.WriteU8 (m_lcid);
+  i.WriteU8 (m_flags);
+  i.WriteHtonU32 (m_clientId);
+}
+
+uint32_t
+EvalvidRequestHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_magic = i.ReadNtohU32 ();
+  m_cellId = i.ReadNtohU16 ();
+  m_rnti = i.ReadNtohU16 ();
+  m_lcid = i.ReadU8 ();
+  m_flags = i.ReadU8 ();
+  m_clientId = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+EvalvidRequestHeader::Print (std::ostream &os) const
+{
+  os << "(cell=" << m_cellId << " rnti=" << m_rnti << " lcid=" << (uint32_t) m_lcid << " client=" << m_clientId
+     << (GetFollowFiles () ? " follows files" : "") << ")";
+}
+
+void
+EvalvidRequestHeader::SetCellId (uint16_t cellId)
+{
+  m_cellId = cellId;
+}
+
+uint16_t
+EvalvidRequestHeader::GetCellId (void) const
+{
+  return m_cellId;
+}
+
+void
+EvalvidRequestHeader::SetRnti (uint16_t rnti)
+{
+  m_rnti = rnti;
+}
+
+uint16_t
+EvalvidRequestHeader::GetRnti (void) const
+{
+  return m_rnti;
+}
+
+void
+EvalvidRequestHeader::SetLcid (uint8_t lcid)
+{
+  m_lcid = lcid;
+}
+
+uint8_t
+EvalvidRequestHeader::GetLcid (void) const
+{
+  return m_lcid;
+}
+
+void
+EvalvidRequestHeader::SetClientId (uint32_t id)
+{
+  m_clientId = id;
+}
+
+uint32_t
+EvalvidRequestHeader::GetClientId (void) const
+{
+  return m_clientId;
+}
+
+void
+EvalvidRequestHeader::SetFollowFiles (bool follow)
+{
+  m_flags = follow ? (m_flags | FOLLOW_FILES) : (m_flags & ~FOLLOW_FILES);
+}
+
+bool
+EvalvidRequestHeader::GetFollowFiles (void) const
+{
+  return (m_flags & FOLLOW_FILES) != 0;
+}
+
+bool
+EvalvidRequestHeader::IsRequest (Ptr<const Packet> packet)
+{
+  EvalvidRequestHeader header;
+  if (packet->GetSize () < header.GetSerializedSize ())
+    {
+      return false;
+    }
+  packet->PeekHeader (header);
+  return header.m_magic == MAGIC;
+}
+
+} // namespace ns3
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_REQUEST_HEADER_H__
+#define __EVALVID_REQUEST_HEADER_H__
+
+#include "ns3/header.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidRequestHeader
+ * \brief Streaming request details sent by EvalvidClient after the SeqTsHeader.
+ *
+ * It names the LTE bearer the client is served over, by cell, RNTI and
+ * LCID, so that EvalvidServer follows the congestion hints of that bearer
+ * only. Requests without it, or with a cell or RNTI of 0, get no hints.
+ * The client id names the files the server and the client share, and a
+ * client following the videoType1 and bitRate files asks for them to be
+ * written line by line.
+ */
+class EvalvidRequestHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  EvalvidRequestHeader ();
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  /// \param cellId cell serving the client, 0 if unknown
+  void SetCellId (uint16_t cellId);
+  uint16_t GetCellId (void) const;
+  /// \param rnti RNTI of the bearer of the client, 0 if unknown
+  void SetRnti (uint16_t rnti);
+  uint16_t GetRnti (void) const;
+  /// \param lcid LCID of the bearer of the client, 0 for any bearer of the RNTI
+  void SetLcid (uint8_t lcid);
+  uint8_t GetLcid (void) const;
+  /// \param id ClientId of the client, 0 if not set
+  void SetClientId (uint32_t id);
+  uint32_t GetClientId (void) const;
+  /// \param follow the client reads videoType1 and bitRate in legacy file signalling mode
+  void SetFollowFiles (bool follow);
+  bool GetFollowFiles (void) const;
+
+  /**
+   * \param packet a streaming request, SeqTsHeader removed
+   * \returns true if the packet starts with an EvalvidRequestHeader
+   */
+  static bool IsRequest (Ptr<const Packet> packet);
+
+private:
+  static const uint32_t MAGIC = 0x45565251; // "EVRQ"
+  static const uint8_t FOLLOW_FILES = 0x01;
+
+  uint32_t m_magic;
+  uint16_t m_cellId;
+  uint16_t m_rnti;
+  uint8_t  m_lcid;
+  uint8_t  m_flags;
+  uint32_t m_clientId;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_REQUEST_HEADER_H__
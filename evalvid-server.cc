@@ -24,17 +24,34 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
 #include "ns3/socket.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/type-id.h"
+#include "ns3/object-factory.h"
 
 #include "evalvid-server.h"
+#include "evalvid-frame-tag.h"
+#include "evalvid-feedback-header.h"
+#include "evalvid-request-header.h"
+#include "evalvid-hint-bus.h"
+#include "evalvid-rendition-catalog.h"
+#include "evalvid-abr.h"
+#include "evalvid-synthetic-source.h"
 #include "ns3/tag.h"
 #include "ns3/qos-tag.h"
 
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+
 
 using namespace std;
 
@@ -56,10 +73,27 @@ EvalvidServer::GetTypeId (void)
                    MakeUintegerAccessor (&EvalvidServer::m_port),
                    MakeUintegerChecker<uint16_t> ())
     .AddAttribute ("SenderDumpFilename",
-                   "Sender Dump Filename",
+                   "Sender Dump Filename. The sender dump, videoType1 and bitRate of a client "
+                   "with a non zero ClientId are suffixed with _<id>; those of a client whose "
+                   "id is already served with _<address>_<port> of the client.",
                    StringValue(""),
                    MakeStringAccessor(&EvalvidServer::m_senderTraceFileName),
                    MakeStringChecker())
+    .AddAttribute ("BinaryDump",
+                   "Write the sender dump and the videoType1 file as binary records, to be "
+                   "converted to the Evalvid text by evalvid-dump-converter. The videoType1 "
+                   "of a client in legacy file signalling mode is always text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidServer::m_binaryDump),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncOutput",
+                   "Format and write the sender dump, videoType1 and bitRate on the "
+                   "EvalvidOutputThread. The videoType1 and bitRate of a client in legacy "
+                   "file signalling mode, which tells so in its request, are always "
+                   "written line by line.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&EvalvidServer::m_asyncOutput),
+                   MakeBooleanChecker ())
     .AddAttribute ("SenderTraceFilename",
                    "Sender trace Filename",
                    StringValue(""),
@@ -71,6 +105,69 @@ EvalvidServer::GetTypeId (void)
                    UintegerValue (1460),
                    MakeUintegerAccessor (&EvalvidServer::m_packetPayload),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CongestionBackoff",
+                   "Factor applied to the requested rate of a session on every congestion "
+                   "loss hint of its bearer, until the next rate feedback of its client. "
+                   "1.0 disables the reaction.",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&EvalvidServer::m_congestionBackoff),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("LegacyFileSignalling",
+                   "Take the requested rate from the videoRate file written by EvalvidClient "
+                   "instead of the in-band feedback. The file is read incrementally.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidServer::m_legacyFileSignalling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AbrType",
+                   "Type of the EvalvidAbr algorithm picking the rendition to send.",
+                   TypeIdValue (EvalvidThroughputAbr::GetTypeId ()),
+                   MakeTypeIdAccessor (&EvalvidServer::m_abrType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("PacingFactor",
+                   "Spread the fragments of a frame evenly over this fraction of the "
+                   "frame interval. 0 sends them back to back.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&EvalvidServer::m_pacingFactor),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PacingRate",
+                   "Send the fragments at this rate instead of spreading them over the "
+                   "frame interval. 0 disables it.",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&EvalvidServer::m_pacingRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("SyntheticVideo",
+                   "Generate the frames from a model fitted on SenderTraceFilename instead "
+                   "of replaying the traces. Renditions are generated at the ladder bitrates, "
+                   "so their trace files are not needed, and the video never loops.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidServer::m_syntheticVideo),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DerivedRenditions",
+                   "Derive the ladder renditions from SenderTraceFilename by scaling its "
+                   "frame sizes, instead of loading their trace files. A rendition is "
+                   "derived the first time a session switches to it.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EvalvidServer::m_derivedRenditions),
+                   MakeBooleanChecker ())
+    .AddAttribute ("IFrameRateExponent",
+                   "Exponent of the bitrate ratio scaling the I frames of derived renditions.",
+                   DoubleValue (0.8),
+                   MakeDoubleAccessor (&EvalvidServer::m_iFrameRateExponent),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PFrameRateExponent",
+                   "Exponent of the bitrate ratio scaling the P frames of derived renditions.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&EvalvidServer::m_pFrameRateExponent),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("BFrameRateExponent",
+                   "Exponent of the bitrate ratio scaling the B frames of derived renditions.",
+                   DoubleValue (1.2),
+                   MakeDoubleAccessor (&EvalvidServer::m_bFrameRateExponent),
+                   MakeDoubleChecker<double> (0.0))
+    .AddTraceSource ("FrameTx",
+                     "A video frame was sent: frame id, frame type, frame size, "
+                     "id of its first packet and number of packets.",
+                     MakeTraceSourceAccessor (&EvalvidServer::m_frameTxTrace))
     ;
   return tid;
 }
@@ -78,29 +175,31 @@ EvalvidServer::GetTypeId (void)
 EvalvidServer::EvalvidServer ()
  {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
   m_port = 0;
   m_numOfFrames = 0;
   m_packetPayload = 0;
-  m_packetId = 0;
-  m_sendEvent = EventId ();
   flag=0;
   pG = 0;
   pB = 0.4;
   pGB = 0.04;
   pBG = 0.06;
-  m_chunkTime = 0;
-  m_chunkSize = 0;
-  m_aveBitrate = 0;
-  m_chunkCnt = 0;
-  m_sumCnt = 0;
+  m_congestionBackoff = 0.9;
+  m_legacyFileSignalling = false;
+  m_pacingFactor = 0;
+  m_syntheticVideo = false;
+  m_binaryDump = false;
+  m_asyncOutput = true;
+  m_derivedRenditions = false;
+  m_iFrameRateExponent = 0.8;
+  m_pFrameRateExponent = 1.0;
+  m_bFrameRateExponent = 1.2;
+  m_pacedPackets = 0;
+  m_pacingDelaySum = 0;
+  m_pacingDelayMax = 0;
+  m_congestionLossCnt = 0;
+  m_bufferDropCnt = 0;
+  m_videoTypeFileName = "videoType1";
   m_bitRateFileName = "bitRate";
-  m_bitRateFile.open(m_bitRateFileName.c_str(), ios::out);
-  if (m_bitRateFile.fail())
-   {
-     NS_FATAL_ERROR(">> EvalvidServer: Error while opening bit rate file: " << m_bitRateFileName.c_str());
-     return;
-   }
 }
 
 EvalvidServer::~EvalvidServer ()
@@ -112,6 +211,21 @@ void
 EvalvidServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_catalog = 0;
+  m_videoModel = 0;
+  for (SessionMap::iterator it = m_sessions.begin (); it != m_sessions.end (); ++it)
+    {
+      CancelEvents (it->second);
+      Unsubscribe (it->second);
+      if (it->second->synthetic != 0)
+        {
+          it->second->synthetic->Dispose ();
+        }
+      it->second->senderTraceFile.Close ();
+      it->second->videoTypeFile.Close ();
+      it->second->bitRateFile.Close ();
+    }
+  m_sessions.clear ();
   Application::DoDispose ();
 }
 
@@ -146,6 +260,8 @@ EvalvidServer::StartApplication (void)
       socket6->SetRecvCallback (MakeCallback (&EvalvidServer::HandleRead, this));
     }
 
+  m_ladder = EvalvidAbr::GetDefaultLadder ();
+
   //Load video trace file
   Setup();
 }
@@ -154,7 +270,22 @@ void
 EvalvidServer::StopApplication ()
 {
   NS_LOG_FUNCTION_NOARGS();
-  //Simulator::Cancel (m_sendEvent);
+  for (SessionMap::iterator it = m_sessions.begin (); it != m_sessions.end (); ++it)
+    {
+      CancelEvents (it->second);
+      Unsubscribe (it->second);
+      it->second->senderTraceFile.Flush ();
+      it->second->videoTypeFile.Flush ();
+      it->second->bitRateFile.Flush ();
+    }
+  NS_LOG_INFO (">> EvalvidServer: RLC drops " << m_bufferDropCnt
+               << ", congestion losses " << m_congestionLossCnt);
+  if (m_pacedPackets > 0)
+    {
+      NS_LOG_INFO (">> EvalvidServer: Paced packets " << m_pacedPackets
+                   << ", mean pacing delay " << m_pacingDelaySum / m_pacedPackets
+                   << "s, max pacing delay " << m_pacingDelayMax << "s");
+    }
 }
 
 void
@@ -162,297 +293,479 @@ EvalvidServer::Setup()
 {
   NS_LOG_FUNCTION_NOARGS();
 
-  m_videoInfoStruct_t *videoInfoStruct;
-  uint32_t frameId;
-  string frameType;
-  uint32_t frameSize;
-  uint16_t numOfUdpPackets;
-  double sendTime;
-  double lastSendTime = 0.0;
+  //Load the trace given by the user and the renditions of the ladder.
+  //The catalog is shared with every other server loading the same files.
+  //Synthetic and derived renditions are made from the trace given by the user.
+  vector<string> fileNames;
+  fileNames.push_back (m_videoTraceFileName);
+  for (uint32_t i = 0; i < m_ladder.size () && !m_syntheticVideo && !m_derivedRenditions; i++)
+    {
+      if (m_videoTraceFileName != m_ladder[i].fileName)
+        {
+          fileNames.push_back (m_ladder[i].fileName);
+        }
+    }
+  m_catalog = EvalvidRenditionCatalog::Get (fileNames);
 
-  //Open file from mp4trace tool of EvalVid.
-  ifstream videoTraceFile(m_videoTraceFileName.c_str(), ios::in);
-  if (videoTraceFile.fail())
+  const EvalvidRendition &rendition = m_catalog->GetRendition (0);
+  if (rendition.IsEmpty ())
     {
       NS_FATAL_ERROR(">> EvalvidServer: Error while opening video trace file: " << m_videoTraceFileName.c_str());
       return;
     }
 
-  //Store video trace information on the struct
-  while (videoTraceFile >> frameId >> frameType >> frameSize >> numOfUdpPackets >> sendTime)
+  m_numOfFrames = rendition.GetFrame (rendition.GetNFrames () - 1).frameId;
+  if (m_syntheticVideo)
     {
-      videoInfoStruct = new m_videoInfoStruct_t;
-      videoInfoStruct->frameType = frameType;
-      videoInfoStruct->frameSize = frameSize;
-      videoInfoStruct->frameId = frameId;
-      videoInfoStruct->numOfUdpPackets = numOfUdpPackets;
-      videoInfoStruct->packetInterval = Seconds(sendTime - lastSendTime);
-      videoInfoStruct->sendTime = Seconds(sendTime);
-      m_videoInfoMap.insert (pair<uint32_t, m_videoInfoStruct_t*>(frameId, videoInfoStruct));
-      NS_LOG_LOGIC(">> EvalvidServer: " << frameId << "\t" << frameType << "\t" <<
-                                frameSize << "\t" << numOfUdpPackets << "\t" << sendTime);
-      lastSendTime = sendTime;
+      m_videoModel = EvalvidVideoModel::Fit (rendition);
     }
+  m_rateModel.iExponent = m_iFrameRateExponent;
+  m_rateModel.pExponent = m_pFrameRateExponent;
+  m_rateModel.bExponent = m_bFrameRateExponent;
+  m_rateModel.packetPayload = m_packetPayload;
+}
 
-  m_numOfFrames = frameId;
-  m_videoInfoMapIt = m_videoInfoMap.begin();
+void
+EvalvidServer::OpenSessionFiles (Ptr<Session> session)
+{
+  // The files are suffixed with the ClientId, as the client names its own.
+  // A second client with the same id cannot find its files: its names get
+  // its address instead, e.g. sd_7.0.0.2_49153.
+  std::ostringstream suffix;
+  if (session->clientId != 0)
+    {
+      suffix << "_" << session->clientId;
+    }
+  for (SessionMap::const_iterator it = m_sessions.begin (); it != m_sessions.end (); ++it)
+    {
+      if (it->second == session || it->second->fileSuffix != suffix.str ())
+        {
+          continue;
+        }
+      if (m_legacyFileSignalling)
+        {
+          NS_FATAL_ERROR(">> EvalvidServer: Two clients with ClientId " << session->clientId
+                         << ", their files would be mixed up in legacy file signalling mode");
+        }
+      NS_LOG_WARN(">> EvalvidServer: ClientId " << session->clientId << " already served, "
+                  "naming the files of " << session->peerAddress << " after its address");
+      if (InetSocketAddress::IsMatchingType (session->peerAddress))
+        {
+          InetSocketAddress address = InetSocketAddress::ConvertFrom (session->peerAddress);
+          suffix << "_" << address.GetIpv4 () << "_" << address.GetPort ();
+        }
+      else if (Inet6SocketAddress::IsMatchingType (session->peerAddress))
+        {
+          Inet6SocketAddress address = Inet6SocketAddress::ConvertFrom (session->peerAddress);
+          suffix << "_" << address.GetIpv6 () << "_" << address.GetPort ();
+        }
+      break;
+    }
+  session->fileSuffix = suffix.str ();
 
-  //Open file to store information of packets transmitted by EvalvidServer.
-  m_senderTraceFile.open(m_senderTraceFileName.c_str(), ios::out);
-  if (m_senderTraceFile.fail())
+  //Open file to store information of packets transmitted to the client.
+  string senderTraceFileName = m_senderTraceFileName + session->fileSuffix;
+  if (!session->senderTraceFile.Open (senderTraceFileName, EvalvidDumpWriter::PACKET_DUMP, m_binaryDump,
+                                      1 << 20, m_asyncOutput))
     {
-      NS_FATAL_ERROR(">> EvalvidServer: Error while opening sender trace file: " << m_senderTraceFileName.c_str());
+      NS_FATAL_ERROR(">> EvalvidServer: Error while opening sender trace file: " << senderTraceFileName.c_str());
       return;
     }
-   // chun: add
-   m_videoTypeFileName = "videoType1";
-   m_videoTypeFile.open(m_videoTypeFileName.c_str(), ios::out);
-   if (m_videoTypeFile.fail())
+  // chun: add
+  // Text written line by line for the clients following it.
+  bool async = m_asyncOutput && !session->followFiles;
+  string videoTypeFileName = m_videoTypeFileName + session->fileSuffix;
+  if (!session->videoTypeFile.Open (videoTypeFileName, EvalvidDumpWriter::VIDEO_TYPE_DUMP,
+                                    m_binaryDump && !session->followFiles, async ? 1 << 20 : 0, async))
     {
-      NS_FATAL_ERROR(">> EvalvidServer: Error while opening video type file: " << m_videoTypeFileName.c_str());
+      NS_FATAL_ERROR(">> EvalvidServer: Error while opening video type file: " << videoTypeFileName.c_str());
       return;
     }
+  string bitRateFileName = m_bitRateFileName + session->fileSuffix;
+  if (!session->bitRateFile.Open (bitRateFileName, EvalvidDumpWriter::BIT_RATE_DUMP, false,
+                                  async ? 1 << 16 : 0, async))
+    {
+      NS_FATAL_ERROR(">> EvalvidServer: Error while opening bit rate file: " << bitRateFileName.c_str());
+      return;
+    }
+  if (m_legacyFileSignalling)
+    {
+      session->videoRateReader.SetFileName ("videoRate" + session->fileSuffix);
+    }
 }
 void
-EvalvidServer::Send ()
+EvalvidServer::Send (Ptr<Session> session)
 {
   NS_LOG_FUNCTION( this << Simulator::Now().GetSeconds());
-  double rate = 0;
-  double scale = 1.0;
-  m_videoRateFileName = "videoRate";
-  ifstream videoRateFile(m_videoRateFileName.c_str(), ios::in);
-  if (videoRateFile.fail())
-  {
-         NS_FATAL_ERROR(">> EvalvidServer: Error while opening receive video rate file: " << m_videoRateFileName.c_str());
-         return;
-  }
-  while (videoRateFile >> rate) // read the rate when it decreases
-  {
-  }
-  if (m_lastRate != rate /*&& 3 < m_chunkCnt*/) {
-          if (rate/scale >= 2850) {
-                m_videoTraceFileName = "st_foreman_cif_2M.st";
-                m_fileName = 2;
-          } else if (rate/scale >= 2570) {
-                m_videoTraceFileName = "st_foreman_cif_1.8M.st";
-                m_fileName = 1.8;
-          } else if (rate/scale >= 2280) {
-                m_videoTraceFileName = "st_foreman_cif_1.6M.st";
-                m_fileName = 1.6;
-          } else if (rate/scale >= 2000) {
-                m_videoTraceFileName = "st_foreman_cif_1.4M.st";
-                m_fileName = 1.4;
-          } else if (rate/scale >= 1710) {
-                m_videoTraceFileName = "st_foreman_cif_1.2M.st";
-                m_fileName = 1.2;
-          } else if (rate/scale >= 1420) {
-                m_videoTraceFileName = "st_foreman_cif_1M.st";
-                m_fileName = 1;
-          } else if (rate/scale >= 1140) {
-                m_videoTraceFileName = "st_foreman_cif_0.8M.st";
-                m_fileName = 0.8;
-          } else if (rate/scale >= 850) {
-                m_videoTraceFileName = "st_foreman_cif_0.6M.st";
-                m_fileName = 0.6;
-          } else if (rate/scale >= 570) {
-                m_videoTraceFileName = "st_foreman_cif_0.4M.st";
-                m_fileName = 0.4;
-          } else if (rate/scale >= 285) {
-                m_videoTraceFileName = "st_foreman_cif_0.2M.st";
-                m_fileName = 0.2;
-          }
-        m_lastRate = rate;
-        NS_LOG_INFO(">> Change file: "<< m_lastFileName <<", file: " << m_fileName << ",videoTraceFileName: " << m_videoTraceFileName);
-        if (m_lastFileName != m_fileName ) {
-          m_lastFileName = m_fileName;
-          m_videoInfoStruct_t *videoInfoStruct;
-          uint32_t frameId;
-          string frameType;
-          uint32_t frameSize;
-          uint16_t numOfUdpPackets;
-          double sendTime;
-          double lastSendTime = 0.0;
-          // Open file from mp4trace tool of EvalVid.
-          ifstream videoTraceFile(m_videoTraceFileName.c_str(), ios::in);
-          if (videoTraceFile.fail())
+
+  // Frames following a frame with a zero interval leave at the same time:
+  // send them all from this event instead of scheduling one event each.
+  for (uint32_t burst = 0; ; burst++)
+    {
+      UpdateRendition (session);
+
+      const EvalvidTraceFrame *frame;
+      uint32_t burstLimit;
+      if (session->synthetic != 0)
+        {
+          frame = &session->synthetic->GetNextFrame ();
+          burstLimit = session->synthetic->GetModel ()->GetGopLength ();
+          SendFrame (session, *frame);
+        }
+      else
+        {
+          if (session->pendingRendition != session->renditionIndex
+              && (!session->hasChunk
+                  || m_catalog->GetRendition (session->renditionIndex).IsChunkStart (session->frameIndex)))
             {
-              NS_FATAL_ERROR(">> EvalvidServer: Error while opening video trace file: " << m_videoTraceFileName.c_str());
-              return;
+              SwitchRendition (session);
             }
 
-          // Store video trace information on the struct
-          m_videoInfoMap.erase(m_videoInfoMap.begin (), m_videoInfoMap.end ());
-          while (videoTraceFile >> frameId >> frameType >> frameSize >> numOfUdpPackets >> sendTime)
+          const EvalvidRendition &rendition = m_catalog->GetRendition (session->renditionIndex);
+          if (session->frameIndex >= rendition.GetNFrames () || Simulator::Now().ToDouble(Time::S) > 100)
             {
-              videoInfoStruct = new m_videoInfoStruct_t;
-              videoInfoStruct->frameType = frameType;
-              videoInfoStruct->frameSize = frameSize;
-              videoInfoStruct->frameId = frameId;
-              videoInfoStruct->numOfUdpPackets = numOfUdpPackets;
-              videoInfoStruct->packetInterval = Seconds(sendTime - lastSendTime);
-              videoInfoStruct->sendTime = Seconds(sendTime);
-              m_videoInfoMap.insert (pair<uint32_t, m_videoInfoStruct_t*>(frameId, videoInfoStruct));
-              NS_LOG_LOGIC(">> EvalvidServer: " << frameId << "\t" << frameType << "\t" <<
-                                        frameSize << "\t" << numOfUdpPackets << "\t" << sendTime);
-              lastSendTime = sendTime;
+              NS_FATAL_ERROR(">> EvalvidServer: Frame does not exist!");
             }
-            NS_LOG_INFO(">> m_frameId: "<< m_frameId << ",videoTraceFileName: " << m_videoTraceFileName);
-            m_videoInfoMapIt = m_videoInfoMap.begin(); 
-            while (0 < m_frameId){
-                m_videoInfoMapIt++;
-                m_frameId--;
+          frame = &rendition.GetFrame (session->frameIndex);
+          burstLimit = rendition.GetNFrames ();
+          SendFrame (session, *frame);
+
+          session->frameIndex++;
+          if (session->frameIndex == rendition.GetNFrames ()) {
+            // Loop the video, skipping its first 26 frames.
+            session->frameIndex = rendition.GetNFrames () > 26 ? 26 : 0;
             }
-            m_chunkTime = 0; 
-            m_chunkSize = 0;
-            m_chunkCnt = 0;
         }
-      }
-  if (m_videoInfoMapIt != m_videoInfoMap.end() && Simulator::Now().ToDouble(Time::S) <= 100)
-    {
-      NS_LOG_LOGIC(">> EvalvidServer Sender: " << m_videoTraceFileName << "\t" << m_videoInfoMapIt->second->frameId << "\t" 
-                << m_videoInfoMapIt->second->frameType << "\t" 
-                << m_videoInfoMapIt->second->frameSize << "\t" << m_videoInfoMapIt->second->numOfUdpPackets);
-       //QosTag tag;
-      //Sending the frame in multiples segments
-      for(int i=0; i<m_videoInfoMapIt->second->numOfUdpPackets - 1; i++)
-        {
-          Ptr<Packet> p = Create<Packet> (m_packetPayload);
-          m_packetId++;
 
-          if (InetSocketAddress::IsMatchingType (m_peerAddress))
-            {
-              NS_LOG_DEBUG(">> EvalvidServer: Send packet at " << Simulator::Now().GetSeconds() << "s\tid: " << m_packetId
-                            << "\tudp\t" << p->GetSize() << " to " << InetSocketAddress::ConvertFrom (m_peerAddress).GetIpv4 ()
-                            << std::endl);
-              NS_LOG_INFO(">> Send Pid: "<<m_packetId<<" Type: "<<m_videoInfoMapIt->second->frameType);
-              if(m_videoInfoMapIt->second->frameType == "H"){
+      if (frame->packetInterval != 0)
+        {
+          Time interval = MicroSeconds (frame->packetInterval);
+          NS_LOG_INFO(">> interval :" << interval);
+          session->sendEvent = Simulator::Schedule (interval, &EvalvidServer::Send, this, session);
+          break;
+        }
+      if (burst == burstLimit)
+        {
+          // A trace without intervals: yield to the other events.
+          session->sendEvent = Simulator::ScheduleNow (&EvalvidServer::Send, this, session);
+          break;
+        }
+    }
+}
 
-              } else if(m_videoInfoMapIt->second->frameType == "P"){
+void
+EvalvidServer::UpdateRendition (Ptr<Session> session)
+{
+  double rate = session->requestedRate; // last rate fed back by the client
+  if (m_legacyFileSignalling)
+    {
+      if (session->videoRateReader.Poll () > 0)
+        {
+          session->legacyRate = atof (session->videoRateReader.GetLastLine ().c_str ());
+        }
+      rate = session->legacyRate;
+    }
+  if (session->lastRate == rate && session->lastClientBuffer == session->clientBuffer)
+    {
+      return;
+    }
 
-              }
-            }
-          else if (Inet6SocketAddress::IsMatchingType (m_peerAddress))
-            {
-              NS_LOG_DEBUG(">> EvalvidServer: Send packet at " << Simulator::Now().GetSeconds() << "s\tid: " << m_packetId
-                            << "\tudp\t" << p->GetSize() << " to " << Inet6SocketAddress::ConvertFrom (m_peerAddress).GetIpv6 ()
-                            << std::endl);
-            }
+  EvalvidAbrInput input;
+  input.requestedRate = rate;
+  input.throughput = session->clientThroughput;
+  input.bufferLevel = GetBufferTime (session);
+  input.current = session->rung;
+  uint32_t rung = session->abr->SelectRendition (input);
+  if (rung < m_ladder.size ())
+    {
+      session->rung = rung;
+      session->videoTraceFileName = m_ladder[rung].fileName;
+      session->fileName = m_ladder[rung].bitrate / 1000;
+    }
+  session->lastClientBuffer = session->clientBuffer;
+  session->lastRate = rate;
+  NS_LOG_INFO(">> Change file: "<< session->lastFileName <<", file: " << session->fileName << ",videoTraceFileName: " << session->videoTraceFileName);
+  if (session->lastFileName == session->fileName)
+    {
+      return;
+    }
 
-          m_senderTraceFile << std::fixed << std::setprecision(4) << Simulator::Now().ToDouble(Time::S)
-                            << std::setfill(' ') << std::setw(16) <<  "id " << m_packetId
-                            << std::setfill(' ') <<  std::setw(16) <<  "udp " << p->GetSize()
-                            << std::endl;
-
-	  m_videoTypeFile  << std::fixed << std::setprecision(4) << m_packetId 
-                           << std::setfill(' ') << std::setw(16) << p->GetUid()
-                           << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameId
-		           << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameType
-                           << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameSize 
-			   << std::endl;
-          SeqTsHeader seqTs;
-          seqTs.SetSeq (m_packetId);
-          p->AddHeader (seqTs);
-          m_socket->SendTo(p, 0, m_peerAddress);
-        }
+  session->lastFileName = session->fileName;
+  if (session->synthetic != 0)
+    {
+      // Generated at the new bitrate from the next chunk on.
+      session->synthetic->SetBitrate (m_ladder[session->rung].bitrate);
+      return;
+    }
+  uint32_t renditionIndex = m_derivedRenditions
+    ? m_catalog->GetDerivedIndex (0, m_ladder[session->rung].bitrate, m_rateModel)
+    : m_catalog->GetIndex (session->videoTraceFileName);
+  if (renditionIndex >= m_catalog->GetNRenditions ()
+      || m_catalog->GetRendition (renditionIndex).IsEmpty ())
+    {
+      NS_FATAL_ERROR(">> EvalvidServer: Error while opening video trace file: " << session->videoTraceFileName.c_str());
+    }
+  // Switched at the next chunk boundary, so that chunks are never mixed.
+  session->pendingRendition = renditionIndex;
+}
 
-      //Sending the rest of the frame
-      Ptr<Packet> p = Create<Packet> (m_videoInfoMapIt->second->frameSize % m_packetPayload);
-      m_packetId++;
+void
+EvalvidServer::SwitchRendition (Ptr<Session> session)
+{
+  const EvalvidRendition &current = m_catalog->GetRendition (session->renditionIndex);
+  const EvalvidRendition &next = m_catalog->GetRendition (session->pendingRendition);
+  uint32_t frameId = current.GetFrame (session->frameIndex).frameId;
+  NS_LOG_INFO(">> frameId: "<< frameId << ",videoTraceFileName: " << next.GetFileName ());
+
+  // Resume the new rendition at the start of the chunk holding the same frame.
+  uint32_t frameIndex = next.GetFrameIndex (frameId);
+  if (frameIndex == next.GetNFrames ())
+    {
+      frameIndex = std::min (session->frameIndex, next.GetNFrames () - 1);
+    }
+  session->renditionIndex = session->pendingRendition;
+  session->frameIndex = next.GetChunk (next.GetChunkOfFrame (frameIndex)).firstFrame;
+}
 
-      if (InetSocketAddress::IsMatchingType (m_peerAddress))
-        {
-          NS_LOG_DEBUG(">> EvalvidServer: Send packet at " << Simulator::Now().GetSeconds() << "s\tid: " << m_packetId
-                       << "\tudp\t" << p->GetSize() << " to " << InetSocketAddress::ConvertFrom (m_peerAddress).GetIpv4 ()
-                       << std::endl);
-          NS_LOG_INFO(">> Send Pid: "<<m_packetId<<" Type: "<<m_videoInfoMapIt->second->frameType);
-          if(m_videoInfoMapIt->second->frameType == "H"){
+void
+EvalvidServer::SendFrame (Ptr<Session> session, const EvalvidTraceFrame &frame)
+{
+  EvalvidFrameTag::FrameType frameType = frame.GetFrameType ();
+  string frameTypeName = EvalvidFrameTag::GetFrameTypeString (frameType);
 
-              } else if(m_videoInfoMapIt->second->frameType == "P"){
+  if (frameType == EvalvidFrameTag::H_FRAME || frameType == EvalvidFrameTag::I_FRAME)
+    {
+      session->gopPosition = 0;
+    }
+  else
+    {
+      session->gopPosition++;
+    }
 
-              }
+  // Chunk boundary: announce the bitrate of the chunk just completed
+  // before the first packet of the new chunk leaves.
+  if (session->synthetic != 0)
+    {
+      if (session->hasChunk && session->synthetic->IsChunkStart ())
+        {
+          AnnounceChunk (session, frame, session->synthetic->GetLastChunk (),
+                         session->synthetic->GetLastChunkName ());
         }
-      else if (Inet6SocketAddress::IsMatchingType (m_peerAddress))
+    }
+  else
+    {
+      const EvalvidRendition &rendition = m_catalog->GetRendition (session->renditionIndex);
+      uint32_t chunk = rendition.GetChunkOfFrame (session->frameIndex);
+      if (session->hasChunk && rendition.IsChunkStart (session->frameIndex))
         {
-          NS_LOG_DEBUG(">> EvalvidServer: Send packet at " << Simulator::Now().GetSeconds() << "s\tid: " << m_packetId
-                       << "\tudp\t" << p->GetSize() << " to " << Inet6SocketAddress::ConvertFrom (m_peerAddress).GetIpv6 ()
-                       << std::endl);
+          const EvalvidRendition &sent = m_catalog->GetRendition (session->chunkRendition);
+          AnnounceChunk (session, frame, sent.GetChunk (session->chunk), sent.GetFileName ());
         }
+      session->chunkRendition = session->renditionIndex;
+      session->chunk = chunk;
+    }
+  session->hasChunk = true;
+  if (frame.packetInterval != 0)
+    {
+      session->lastInterval = frame.packetInterval;
+    }
+  EvalvidFrameHeader frameHeader;
+  frameHeader.SetFrameNo (frame.frameId);
+  frameHeader.SetFrameSequence (session->frames++);
+  frameHeader.SetFrameType (frameType);
+  frameHeader.SetFrameSize (frame.frameSize);
+  frameHeader.SetFragmentCount (frame.numOfUdpPackets);
+  frameHeader.SetFrameInterval (session->lastInterval);
+  frameHeader.SetChunkId (session->chunkIndex);
+  frameHeader.SetChunkStartFrame (session->chunkStartFrame);
+  frameHeader.SetChunkHeadSize (session->chunkHeadSize);
+  frameHeader.SetChunkBitrate (session->chunkBitrate);
+
+  EvalvidFrameTag frameTag;
+  frameTag.SetFrameId (frame.frameId);
+  frameTag.SetFrameType (frameType);
+  frameTag.SetFrameSize (frame.frameSize);
+  frameTag.SetGopPosition (session->gopPosition);
+  frameTag.SetChunkIndex (session->chunkIndex);
+
+  // Without a pacing rate, the fragments are spread over PacingFactor times
+  // the frame interval.
+  Time spacing = Seconds (0);
+  if (m_pacingRate.GetBitRate () == 0 && m_pacingFactor > 0)
+    {
+      spacing = MicroSeconds (m_pacingFactor * session->lastInterval / frame.numOfUdpPackets);
+    }
+
+  //Sending the frame in multiples segments, the last one with the rest of the frame
+  double now = Simulator::Now().ToDouble(Time::S);
+  uint32_t firstPacketId = session->packets + 1;
+  for (uint16_t i = 0; i < frame.numOfUdpPackets; i++)
+    {
+      uint32_t size = i + 1 < frame.numOfUdpPackets ? m_packetPayload : frame.frameSize % m_packetPayload;
+      Ptr<Packet> p = CreateFragment (size, frameHeader);
+      session->packets++;
 
-      m_senderTraceFile << std::fixed << std::setprecision(4) << Simulator::Now().ToDouble(Time::S)
-                        << std::setfill(' ') << std::setw(16) <<  "id " << m_packetId
-                        << std::setfill(' ') <<  std::setw(16) <<  "udp " << p->GetSize()
-                        << std::endl;
-
-      m_videoTypeFile  << std::fixed << std::setprecision(4) << m_packetId 
-                       << std::setfill(' ') << std::setw(16) << p->GetUid()
-                       << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameId
-		       << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameType 
-                       << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameSize
-		       << std::endl;
+      session->videoTypeFile.WriteVideoType (session->packets, p->GetUid (), frame.frameId, frameType, frame.frameSize);
+      p->AddPacketTag (frameTag);
+      uint32_t payloadSize = p->GetSize ();
       SeqTsHeader seqTs;
-      seqTs.SetSeq (m_packetId);
+      seqTs.SetSeq (session->packets);
       p->AddHeader (seqTs);
-      m_socket->SendTo(p, 0, m_peerAddress);
-
 
-      if (m_videoInfoMapIt == m_videoInfoMap.end())
+      if (m_pacingRate.GetBitRate () == 0 && m_pacingFactor == 0)
         {
-          NS_LOG_INFO(">> EvalvidServer: Video streaming successfully completed!");
+          TransmitFragment (session, p, session->packets, payloadSize, Simulator::Now ());
+          continue;
         }
-      else
+      if (m_pacingRate.GetBitRate () != 0)
         {
-          if (m_videoInfoMapIt->second->packetInterval.GetSeconds() == 0)
-            {
-              m_chunkSize += m_videoInfoMapIt->second->frameSize;
-              m_sendEvent = Simulator::ScheduleNow (&EvalvidServer::Send, this);
-            }
-          else
-            {
-              double bitrate = 0.0;
-              Time interval = m_videoInfoMapIt->second->packetInterval;
-              NS_LOG_INFO(">> interval :" << interval);
-              if(m_videoInfoMapIt->second->frameType == "H") {
-                if (0 == m_chunkCnt%3 && 0 < m_chunkTime  && 0 < m_chunkCnt) {
-                bitrate = m_chunkSize*8/(m_chunkTime*1024);
-                NS_LOG_DEBUG(">> Current chunk size: " << m_chunkSize
-                             << "\tchunk Time: " << m_chunkTime
-                             << "\tframeSize: " << m_videoInfoMapIt->second->frameSize
-                             << "\tbitrate: " << bitrate);  
-                m_chunkTime = 0; 
-                m_chunkSize = 0;
-                m_aveBitrate += bitrate;
-                m_sumCnt++;
-                NS_LOG_INFO(">> m_aveBitrate :" << m_aveBitrate/m_sumCnt << ", chunkCnt :" << m_chunkCnt);
-                m_bitRateFile  << std::fixed << std::setprecision(4) << bitrate
-                               << std::setfill(' ') << std::setw(16) << m_videoInfoMapIt->second->frameId - 1
-                               << std::setfill(' ') << std::setw(16) << m_videoTraceFileName
-                               << std::endl; 
-                }
-                m_chunkCnt++;
-                m_frameId = m_videoInfoMapIt->second->frameId - 1;           
-              } 
-	      m_chunkSize += m_videoInfoMapIt->second->frameSize;
-              m_chunkTime += interval.ToDouble(Time::S);
-              m_sendEvent = Simulator::Schedule (interval, &EvalvidServer::Send, this);                    
-            }
-              NS_LOG_DEBUG(">> Current chunk size: " << m_chunkSize
-                             << "\tframeId: " << m_videoInfoMapIt->second->frameId 
-                             << "\tframeSize: " << m_videoInfoMapIt->second->frameSize
-                             << "\tchunk Time: " << m_chunkTime << std::endl);            
-        }
-      m_videoInfoMapIt++;
-      if (m_videoInfoMapIt == m_videoInfoMap.end()) {
-        m_videoInfoMapIt = m_videoInfoMap.begin();
-        uint16_t t = 0;
-        while (25 >= t){
-                m_videoInfoMapIt++;
-                t++;
-         }
+          spacing = Seconds (p->GetSize () * 8.0 / m_pacingRate.GetBitRate ());
         }
+      Time departure = std::max (Simulator::Now (), session->pacerFree);
+      session->pacerFree = departure + spacing;
+      session->pacedEvents.push_back (Simulator::Schedule (departure - Simulator::Now (),
+                                                           &EvalvidServer::TransmitFragment, this,
+                                                           session, p, session->packets, payloadSize,
+                                                           Simulator::Now ()));
     }
-  else
+
+  NS_LOG_DEBUG(">> EvalvidServer: Send frame at " << now << "s\tframe: " << frame.frameId
+               << "\t" << frameTypeName << "\t" << frame.frameSize << " bytes\tids: "
+               << firstPacketId << "-" << session->packets << " to " << session->peerAddress);
+  m_frameTxTrace (frame.frameId, frame.frameType, frame.frameSize, firstPacketId, frame.numOfUdpPackets);
+}
+
+void
+EvalvidServer::AnnounceChunk (Ptr<Session> session, const EvalvidTraceFrame &frame,
+                              const EvalvidChunk &completed, const string &fileName)
+{
+  session->chunkIndex++;
+  if (completed.bitrate > 0)
+    {
+      NS_LOG_DEBUG(">> Current chunk size: " << completed.bytes
+                   << "\tchunk Time: " << completed.duration / 1e6
+                   << "\tframeSize: " << frame.frameSize
+                   << "\tbitrate: " << completed.bitrate);
+      session->aveBitrate += completed.bitrate;
+      session->sumCnt++;
+      NS_LOG_INFO(">> m_aveBitrate :" << session->aveBitrate/session->sumCnt << ", chunkIndex :" << session->chunkIndex);
+      session->bitRateFile.WriteBitRate (completed.bitrate, frame.frameId - 1, fileName);
+      session->chunkBitrate = completed.bitrate;
+      session->chunkStartFrame = frame.frameId - 1;
+      session->chunkHeadSize = frame.frameSize;
+    }
+}
+
+void
+EvalvidServer::TransmitFragment (Ptr<Session> session, Ptr<Packet> p, uint32_t packetId,
+                                 uint32_t payloadSize, Time frameTime)
+{
+  // The running event counts as expired: drop it and those sent before it.
+  while (!session->pacedEvents.empty () && session->pacedEvents.front ().IsExpired ())
+    {
+      session->pacedEvents.pop_front ();
+    }
+  Time delay = Simulator::Now () - frameTime;
+  if (m_pacingRate.GetBitRate () != 0 || m_pacingFactor > 0)
     {
-        NS_FATAL_ERROR(">> EvalvidServer: Frame does not exist!");
+      m_pacedPackets++;
+      m_pacingDelaySum += delay.GetSeconds ();
+      m_pacingDelayMax = std::max (m_pacingDelayMax, delay.GetSeconds ());
+    }
+
+  session->senderTraceFile.WritePacket (Simulator::Now().ToDouble(Time::S), packetId, payloadSize);
+  session->socket->SendTo(p, 0, session->peerAddress);
+}
+
+Ptr<Packet>
+EvalvidServer::CreateFragment (uint32_t size, const EvalvidFrameHeader &header)
+{
+  // The frame header is part of the payload budget, so that fragments of at
+  // least the header size keep their trace size on the wire. Smaller ones,
+  // such as the empty last fragment of a frame filling whole payloads, grow
+  // to the header size; the sender dump logs the size actually sent, as the
+  // receiver dump does, so that the two still match.
+  uint32_t headerSize = header.GetSerializedSize ();
+  Ptr<Packet> p = Create<Packet> (size > headerSize ? size - headerSize : 0);
+  p->AddHeader (header);
+  return p;
+}
+
+double
+EvalvidServer::GetBufferTime (Ptr<const Session> session) const
+{
+  const vector<EvalvidAbrRung> &ladder = session->abr->GetLadder ();
+  double bitrate = session->rung < ladder.size () ? ladder[session->rung].bitrate : ladder[0].bitrate;
+  return session->clientBuffer * 8.0 / (1024 * bitrate);
+}
+
+const EvalvidTraceFrame &
+EvalvidServer::GetCurrentFrame (Ptr<const Session> session) const
+{
+  return m_catalog->GetRendition (session->renditionIndex).GetFrame (session->frameIndex);
+}
+
+void
+EvalvidServer::DeliverHint (EvalvidServer *server, Ptr<Session> session,
+                            const EvalvidCongestionHint &hint)
+{
+  server->HandleHint (session, hint);
+}
+
+void
+EvalvidServer::Subscribe (Ptr<Session> session)
+{
+  // An RNTI names a UE within its cell only: without the cell, no hints.
+  if (session->cellId == 0 || session->rnti == 0 || session->hintSubscription != 0)
+    {
+      return;
+    }
+  session->hintSubscription =
+    EvalvidHintBus::Get ()->Subscribe (session->cellId, session->rnti, session->lcid,
+                                       MakeBoundCallback (&EvalvidServer::DeliverHint, this, session));
+}
+
+void
+EvalvidServer::Unsubscribe (Ptr<Session> session)
+{
+  if (session->hintSubscription != 0)
+    {
+      EvalvidHintBus::Get ()->Unsubscribe (session->hintSubscription);
+      session->hintSubscription = 0;
+    }
+}
+
+void
+EvalvidServer::CancelEvents (Ptr<Session> session)
+{
+  Simulator::Cancel (session->sendEvent);
+  for (std::deque<EventId>::iterator it = session->pacedEvents.begin ();
+       it != session->pacedEvents.end (); ++it)
+    {
+      Simulator::Cancel (*it);
+    }
+  session->pacedEvents.clear ();
+}
+
+void
+EvalvidServer::HandleHint (Ptr<Session> session, const EvalvidCongestionHint &hint)
+{
+  if (hint.event == EvalvidCongestionHint::BUFFER_FULL)
+    {
+      m_bufferDropCnt++;
+    }
+  else if (hint.event == EvalvidCongestionHint::CONGESTION_LOSS)
+    {
+      m_bufferDropCnt++;
+      m_congestionLossCnt++;
+      session->requestedRate *= m_congestionBackoff;
+      NS_LOG_INFO (">> EvalvidServer: Congestion loss at cell " << hint.cellId
+                   << " RNTI " << hint.rnti
+                   << " LCID " << (uint32_t) hint.lcid
+                   << ", tx buffer " << hint.txBufferSize << "/" << hint.maxTxBufferSize
+                   << ", NACK ratio " << hint.nackRatio
+                   << ", requested rate of " << session->peerAddress
+                   << " backed off to " << session->requestedRate);
     }
 }
 
@@ -463,12 +776,26 @@ EvalvidServer::HandleRead (Ptr<Socket> socket)
 
   Ptr<Packet> packet;
   Address from;
-  m_socket = socket;
-
 
   while ((packet = socket->RecvFrom (from)))
     {
-      m_peerAddress = from;
+      SessionMap::iterator it = m_sessions.find (from);
+      if (EvalvidFeedbackHeader::IsFeedback (packet))
+        {
+          EvalvidFeedbackHeader feedback;
+          packet->RemoveHeader (feedback);
+          if (it == m_sessions.end ())
+            {
+              NS_LOG_WARN (">> EvalvidServer: Rate feedback from unknown client " << feedback);
+              continue;
+            }
+          it->second->requestedRate = feedback.GetRequestedBitrate ();
+          it->second->clientThroughput = feedback.GetThroughput ();
+          it->second->clientBuffer = feedback.GetBufferLevel ();
+          NS_LOG_INFO (">> EvalvidServer: Rate feedback " << feedback);
+          continue;
+        }
+
       if (InetSocketAddress::IsMatchingType (from))
         {
           NS_LOG_INFO (">> EvalvidServer: Client at " << InetSocketAddress::ConvertFrom (from).GetIpv4 ()
@@ -480,17 +807,43 @@ EvalvidServer::HandleRead (Ptr<Socket> socket)
                            << " is requesting a video streaming.");
         }
 
-      if (m_videoInfoMapIt != m_videoInfoMap.end())
+      if (it != m_sessions.end ())
+        {
+          NS_LOG_INFO (">> EvalvidServer: Client is already being served, request ignored.");
+          continue;
+        }
+      Ptr<Session> session = CreateSession (from, socket);
+      m_sessions.insert (std::make_pair (from, session));
+      SeqTsHeader seqTs;
+      if (packet->GetSize () >= seqTs.GetSerializedSize ())
+        {
+          packet->RemoveHeader (seqTs);
+          if (EvalvidRequestHeader::IsRequest (packet))
+            {
+              EvalvidRequestHeader request;
+              packet->RemoveHeader (request);
+              NS_LOG_INFO (">> EvalvidServer: Client bearer " << request);
+              session->cellId = request.GetCellId ();
+              session->rnti = request.GetRnti ();
+              session->lcid = request.GetLcid ();
+              session->clientId = request.GetClientId ();
+              session->followFiles = request.GetFollowFiles ();
+            }
+        }
+      OpenSessionFiles (session);
+      Subscribe (session);
+
+      if (session->frameIndex < m_catalog->GetRendition (session->renditionIndex).GetNFrames ())
         {
-          NS_LOG_INFO(">> EvalvidServer: Starting video streaming...");
-          if (m_videoInfoMapIt->second->packetInterval.GetSeconds() == 0)
+          NS_LOG_INFO(">> EvalvidServer: Starting video streaming, " << m_sessions.size () << " sessions");
+          if (session->synthetic != 0 || GetCurrentFrame (session).packetInterval == 0)
             {
-              m_sendEvent = Simulator::ScheduleNow (&EvalvidServer::Send, this);
+              session->sendEvent = Simulator::ScheduleNow (&EvalvidServer::Send, this, session);
             }
           else
             {
-              m_sendEvent = Simulator::Schedule (m_videoInfoMapIt->second->packetInterval,
-                                                 &EvalvidServer::Send, this);
+              session->sendEvent = Simulator::Schedule (MicroSeconds (GetCurrentFrame (session).packetInterval),
+                                                        &EvalvidServer::Send, this, session);
             }
         }
       else
@@ -500,4 +853,58 @@ EvalvidServer::HandleRead (Ptr<Socket> socket)
     }
 }
 
+Ptr<EvalvidServer::Session>
+EvalvidServer::CreateSession (const Address &peerAddress, Ptr<Socket> socket)
+{
+  Ptr<Session> session = Create<Session> ();
+  session->peerAddress = peerAddress;
+  session->socket = socket;
+
+  ObjectFactory abrFactory;
+  abrFactory.SetTypeId (m_abrType);
+  session->abr = abrFactory.Create<EvalvidAbr> ();
+  session->abr->SetLadder (m_ladder);
+  session->rung = m_ladder.size ();
+
+  if (m_videoModel != 0)
+    {
+      session->synthetic = CreateObject<EvalvidSyntheticSource> ();
+      session->synthetic->SetModel (m_videoModel);
+      session->synthetic->SetPacketPayload (m_packetPayload);
+    }
+  session->videoTraceFileName = m_videoTraceFileName;
+  session->renditionIndex = 0;
+  session->pendingRendition = 0;
+  session->frameIndex = 0;
+  session->hasChunk = false;
+  session->chunkRendition = 0;
+  session->chunk = 0;
+  session->packets = 0;
+  session->frames = 0;
+  session->legacyRate = 0;
+  session->requestedRate = 0;
+  session->clientThroughput = 0;
+  session->clientBuffer = 0;
+  session->lastClientBuffer = 0;
+  session->lastRate = 0;
+  session->fileName = 0;
+  session->lastFileName = 0;
+  session->aveBitrate = 0;
+  session->sumCnt = 0;
+  session->gopPosition = 0;
+  session->chunkIndex = 0;
+  session->chunkBitrate = 0;
+  session->chunkStartFrame = 0;
+  session->chunkHeadSize = 0;
+  session->lastInterval = 0;
+  session->pacerFree = Seconds (0);
+  session->cellId = 0;
+  session->rnti = 0;
+  session->lcid = 0;
+  session->hintSubscription = 0;
+  session->clientId = 0;
+  session->followFiles = false;
+  return session;
+}
+
 } // Namespace ns3
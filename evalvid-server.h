@@ -30,6 +30,16 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/seq-ts-header.h"
 #include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "evalvid-frame-header.h"
+#include "evalvid-hint-bus.h"
+#include "evalvid-tail-reader.h"
+#include "evalvid-rendition-catalog.h"
+#include "evalvid-abr.h"
+#include "evalvid-synthetic-source.h"
+#include "evalvid-dump-writer.h"
 
 
 #include <stdio.h>
@@ -37,6 +47,7 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <deque>
 #include <map>
 #include "ns3/qos-tag.h"
 
@@ -76,13 +87,106 @@ protected:
   virtual void DoDispose (void);
 
 private:
+  /// Streaming state of one client, created by its first request.
+  struct Session : public SimpleRefCount<Session>
+  {
+    Address     peerAddress;
+    Ptr<Socket> socket;           //Socket the request arrived on.
+    EventId     sendEvent;
+    Ptr<EvalvidAbr> abr;
+    uint32_t    rung;             //Ladder rung being sent, ladder size before the first switch.
+    string      videoTraceFileName;
+    Ptr<EvalvidSyntheticSource> synthetic; //Frame generator, null when the traces are replayed.
+    uint32_t    renditionIndex;   //Rendition being sent.
+    uint32_t    pendingRendition; //Rendition to switch to at the next chunk boundary.
+    uint32_t    frameIndex;       //Index of the next frame in the rendition.
+    bool        hasChunk;         //A chunk was started.
+    uint32_t    chunkRendition;   //Rendition of the chunk being sent.
+    uint32_t    chunk;            //Index of the chunk being sent in its rendition.
+    uint32_t    packets;          //Packets sent to this client, the id of the last one.
+    uint32_t    frames;           //Frames sent to this client, the sequence number of the next one.
+    uint32_t    clientId;         //ClientId sent with the request, 0 if none.
+    bool        followFiles;      //The client reads videoType1 and bitRate.
+    string      fileSuffix;       //Suffix of the output files, from the client id.
+    EvalvidDumpWriter senderTraceFile;
+    EvalvidDumpWriter videoTypeFile;
+    EvalvidDumpWriter bitRateFile;
+    EvalvidTailReader videoRateReader; //videoRate of the client, in legacy file signalling mode.
+    double      legacyRate;       //Last rate read from videoRate.
+    double      requestedRate;    //Last bitrate requested by the client.
+    double      clientThroughput; //Last throughput reported by the client.
+    uint32_t    clientBuffer;     //Last playback buffer reported by the client (bytes).
+    uint32_t    lastClientBuffer;
+    double      lastRate;
+    double      fileName;
+    double      lastFileName;
+    double      aveBitrate;
+    uint32_t    sumCnt;
+    uint16_t    gopPosition;      //Frames since the last H frame.
+    uint32_t    chunkIndex;       //Chunks started, announced in EvalvidFrameTag.
+    double      chunkBitrate;     //Last announced chunk bitrate.
+    uint32_t    chunkStartFrame;  //Frame preceding the head of the announced chunk.
+    uint32_t    chunkHeadSize;    //Size of the head frame of the announced chunk.
+    uint32_t    lastInterval;     //Last non zero frame interval (us).
+    Time        pacerFree;        //Earliest departure of the next paced fragment.
+    std::deque<EventId> pacedEvents; //Paced fragments not sent yet, in departure order.
+    uint16_t    cellId;           //Cell of the client, 0 if unknown.
+    uint16_t    rnti;             //Bearer of the client, 0 if unknown.
+    uint8_t     lcid;             //Bearer of the client, 0 for any bearer of the RNTI.
+    uint32_t    hintSubscription; //Subscription to the hints of the bearer, 0 if none.
+  };
+  typedef std::map<Address, Ptr<Session> > SessionMap;
 
   virtual void StartApplication (void);
   virtual void StopApplication (void);
 
   void Setup (void);
   void HandleRead (Ptr<Socket> socket);
-  void Send();
+  /// Congestion hint published by LteRlcUm for the bearer of session.
+  void HandleHint (Ptr<Session> session, const EvalvidCongestionHint &hint);
+  /// EvalvidHintBus callback, bound to the server and one of its sessions.
+  static void DeliverHint (EvalvidServer *server, Ptr<Session> session,
+                           const EvalvidCongestionHint &hint);
+  /// Follow the congestion hints of the bearer of session, if it is known.
+  void Subscribe (Ptr<Session> session);
+  void Unsubscribe (Ptr<Session> session);
+  /// Cancel the next frames and the paced fragments of the session.
+  void CancelEvents (Ptr<Session> session);
+  /// Send the frames of the session due now and schedule the next ones.
+  void Send (Ptr<Session> session);
+  /// Run the ABR of the session and switch rendition if it picks another one.
+  void UpdateRendition (Ptr<Session> session);
+  /// Move the session to its pending rendition, at the chunk holding the current frame.
+  void SwitchRendition (Ptr<Session> session);
+  /// Count a new chunk and announce the bitrate of the completed one.
+  void AnnounceChunk (Ptr<Session> session, const EvalvidTraceFrame &frame,
+                      const EvalvidChunk &completed, const string &fileName);
+  /// Fragment and send, or pace, one frame to the session client.
+  void SendFrame (Ptr<Session> session, const EvalvidTraceFrame &frame);
+  /**
+   * \brief send one fragment and log it in the sender dump
+   * \param session the client session
+   * \param p the fragment, SeqTsHeader included
+   * \param packetId id of the fragment
+   * \param payloadSize size logged in the sender dump: the payload actually sent
+   * \param frameTime time the frame was due, to measure the pacing delay
+   */
+  void TransmitFragment (Ptr<Session> session, Ptr<Packet> p, uint32_t packetId,
+                         uint32_t payloadSize, Time frameTime);
+  Ptr<Session> CreateSession (const Address &peerAddress, Ptr<Socket> socket);
+  /// Name the files of the session after its client id and open its sender dump, videoType1 and bitRate.
+  void OpenSessionFiles (Ptr<Session> session);
+  /**
+   * \brief create a video fragment carrying an EvalvidFrameHeader
+   * \param size size of the fragment in the trace, header included
+   * \param header the frame header
+   * \returns the fragment, of at least the header size
+   */
+  Ptr<Packet> CreateFragment (uint32_t size, const EvalvidFrameHeader &header);
+  /// \returns the frame of the session rendition about to be sent.
+  const EvalvidTraceFrame &GetCurrentFrame (Ptr<const Session> session) const;
+  /// \returns the playback buffer of the client in seconds of its current rung.
+  double GetBufferTime (Ptr<const Session> session) const;
 
 
   string      m_videoTraceFileName;	        //File from mp4trace tool of Evalvid.
@@ -90,26 +194,26 @@ private:
   fstream     m_videoTraceFile;
   uint32_t    m_numOfFrames;
   uint16_t    m_packetPayload;
-  ofstream    m_senderTraceFile;
-  string      m_videoRateFileName;
-  ofstream    m_videoRateFile;
-  uint32_t    m_packetId;
+  bool        m_binaryDump;
+  TypeId      m_abrType;
+  std::vector<EvalvidAbrRung> m_ladder;
+  SessionMap  m_sessions;
+  double      m_pacingFactor;
+  DataRate    m_pacingRate;
+  uint32_t    m_pacedPackets;
+  double      m_pacingDelaySum;  //s
+  double      m_pacingDelayMax;  //s
+  /// Frame id, EvalvidFrameTag::FrameType, frame size, first packet id, number of packets.
+  TracedCallback<uint32_t, uint8_t, uint32_t, uint32_t, uint16_t> m_frameTxTrace;
+  double      m_congestionBackoff;
+  uint32_t    m_congestionLossCnt;
+  uint32_t    m_bufferDropCnt;
+  bool        m_legacyFileSignalling;
   uint16_t    m_port;
-  Ptr<Socket> m_socket;
-  Address     m_peerAddress;
-  EventId     m_sendEvent;
   // chun: add
-  double      m_lastFileName;
-  double      m_fileName;
   string      m_videoTypeFileName;
-  ofstream    m_videoTypeFile;
-  double      m_chunkSize;
-  double      m_chunkTime;
-  double      m_aveBitrate;
-  uint32_t    m_chunkCnt;
-  uint32_t    m_sumCnt;
   string      m_bitRateFileName;
-  ofstream    m_bitRateFile;
+  bool        m_asyncOutput;
   double      pG;
   double      pB;
   double      pGB;
@@ -121,20 +225,14 @@ private:
   int         corrunt_state;
   int         flag;
   double      corrunt_p;
-  double      m_lastRate;
-  uint32_t    m_frameId;
-  struct m_videoInfoStruct_t
-  {
-    string   frameType;
-    uint32_t frameSize;
-    uint32_t frameId;
-    uint16_t numOfUdpPackets;
-    Time     packetInterval;
-    Time     sendTime;
-  };
-
-  map<uint32_t, m_videoInfoStruct_t*> m_videoInfoMap;
-  map<uint32_t, m_videoInfoStruct_t*>::iterator m_videoInfoMapIt;
+  Ptr<const EvalvidRenditionCatalog> m_catalog;  //Renditions shared by all servers.
+  bool        m_syntheticVideo;
+  bool        m_derivedRenditions;
+  double      m_iFrameRateExponent;
+  double      m_pFrameRateExponent;
+  double      m_bFrameRateExponent;
+  EvalvidRateModel m_rateModel;                  //Scaling of the derived renditions.
+  Ptr<const EvalvidVideoModel> m_videoModel;     //Model of the synthetic renditions, if any.
 };
 
 } // namespace ns3
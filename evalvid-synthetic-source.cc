@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+
+#include "evalvid-synthetic-source.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidSyntheticSource");
+
+NS_OBJECT_ENSURE_REGISTERED (EvalvidSyntheticSource);
+
+EvalvidVideoModel::EvalvidVideoModel ()
+  : m_bitrate (0)
+{
+  for (uint32_t i = 0; i <= EvalvidFrameTag::B_FRAME; i++)
+    {
+      m_logMean[i] = 0;
+      m_logStdDev[i] = 0;
+    }
+}
+
+Ptr<const EvalvidVideoModel>
+EvalvidVideoModel::Fit (const EvalvidRendition &rendition)
+{
+  NS_ABORT_MSG_IF (rendition.IsEmpty (), "EvalvidVideoModel: empty rendition " << rendition.GetFileName ());
+  Ptr<EvalvidVideoModel> model (new EvalvidVideoModel (), false);
+
+  double sum[EvalvidFrameTag::B_FRAME + 1] = { 0 };
+  double sumSquares[EvalvidFrameTag::B_FRAME + 1] = { 0 };
+  uint32_t count[EvalvidFrameTag::B_FRAME + 1] = { 0 };
+  bool timedH = false;
+  for (uint32_t i = 0; i < rendition.GetNFrames (); i++)
+    {
+      const EvalvidTraceFrame &frame = rendition.GetFrame (i);
+      timedH = timedH || (frame.GetFrameType () == EvalvidFrameTag::H_FRAME && frame.packetInterval != 0);
+      if (frame.frameSize > 0)
+        {
+          double logSize = std::log ((double) frame.frameSize);
+          sum[frame.frameType] += logSize;
+          sumSquares[frame.frameType] += logSize * logSize;
+          count[frame.frameType]++;
+        }
+    }
+  for (uint32_t i = 0; i <= EvalvidFrameTag::B_FRAME; i++)
+    {
+      if (count[i] > 0)
+        {
+          model->m_logMean[i] = sum[i] / count[i];
+          double variance = sumSquares[i] / count[i] - model->m_logMean[i] * model->m_logMean[i];
+          model->m_logStdDev[i] = std::sqrt (std::max (variance, 0.0));
+        }
+    }
+  model->m_bitrate = rendition.GetBitrate ();
+
+  // The first complete GOP; the whole trace if there are less than two GOP heads.
+  uint32_t begin = rendition.GetNFrames ();
+  uint32_t end = rendition.GetNFrames ();
+  for (uint32_t i = 0; i < rendition.GetNFrames (); i++)
+    {
+      const EvalvidTraceFrame &frame = rendition.GetFrame (i);
+      bool head = timedH
+        ? frame.GetFrameType () == EvalvidFrameTag::H_FRAME && frame.packetInterval != 0
+        : frame.GetFrameType () == EvalvidFrameTag::I_FRAME;
+      if (head && begin == rendition.GetNFrames ())
+        {
+          begin = i;
+        }
+      else if (head)
+        {
+          end = i;
+          break;
+        }
+    }
+  if (end == rendition.GetNFrames ())
+    {
+      begin = 0;
+    }
+  for (uint32_t i = begin; i < end; i++)
+    {
+      GopFrame gopFrame;
+      gopFrame.type = rendition.GetFrame (i).GetFrameType ();
+      gopFrame.interval = rendition.GetFrame (i).packetInterval;
+      model->m_gop.push_back (gopFrame);
+    }
+
+  NS_LOG_INFO ("EvalvidVideoModel: " << rendition.GetFileName () << ", " << model->m_bitrate
+               << " kbit/s, GOP of " << model->m_gop.size () << " frames");
+  return model;
+}
+
+double
+EvalvidVideoModel::GetBitrate (void) const
+{
+  return m_bitrate;
+}
+
+uint32_t
+EvalvidVideoModel::GetGopLength (void) const
+{
+  return m_gop.size ();
+}
+
+EvalvidFrameTag::FrameType
+EvalvidVideoModel::GetFrameType (uint32_t position) const
+{
+  return m_gop[position].type;
+}
+
+uint32_t
+EvalvidVideoModel::GetFrameInterval (uint32_t position) const
+{
+  return m_gop[position].interval;
+}
+
+double
+EvalvidVideoModel::GetLogMean (EvalvidFrameTag::FrameType type) const
+{
+  return m_logMean[type];
+}
+
+double
+EvalvidVideoModel::GetLogStdDev (EvalvidFrameTag::FrameType type) const
+{
+  return m_logStdDev[type];
+}
+
+TypeId
+EvalvidSyntheticSource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidSyntheticSource")
+    .SetParent<Object> ()
+    .AddConstructor<EvalvidSyntheticSource> ()
+    .AddAttribute ("SceneChangeProbability",
+                   "Probability that a GOP starts a new scene.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&EvalvidSyntheticSource::m_sceneChangeProbability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("SceneChangeScale",
+                   "Size factor of the first I frame of a scene.",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&EvalvidSyntheticSource::m_sceneChangeScale),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("SceneComplexity",
+                   "Standard deviation of the logarithm of the size factor of a scene.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&EvalvidSyntheticSource::m_sceneComplexity),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidSyntheticSource::EvalvidSyntheticSource ()
+  : m_sceneChangeProbability (0.05),
+    m_sceneChangeScale (2.0),
+    m_sceneComplexity (0.25),
+    m_packetPayload (1460),
+    m_bitrate (0),
+    m_pendingBitrate (0),
+    m_scale (1),
+    m_complexity (1),
+    m_sceneChange (false),
+    m_position (0),
+    m_gops (0),
+    m_nFrames (0),
+    m_chunkStart (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_uniform = CreateObject<UniformRandomVariable> ();
+  m_normal = CreateObject<NormalRandomVariable> ();
+  m_frame = EvalvidTraceFrame ();
+  m_chunk = EvalvidChunk ();
+  m_lastChunk = EvalvidChunk ();
+}
+
+EvalvidSyntheticSource::~EvalvidSyntheticSource ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidSyntheticSource::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_uniform = 0;
+  m_normal = 0;
+  Object::DoDispose ();
+}
+
+void
+EvalvidSyntheticSource::SetModel (Ptr<const EvalvidVideoModel> model)
+{
+  NS_ABORT_MSG_IF (model->GetGopLength () == 0, "EvalvidSyntheticSource: model without GOP");
+  m_model = model;
+  if (m_pendingBitrate == 0)
+    {
+      m_pendingBitrate = model->GetBitrate ();
+    }
+}
+
+Ptr<const EvalvidVideoModel>
+EvalvidSyntheticSource::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+EvalvidSyntheticSource::SetPacketPayload (uint16_t packetPayload)
+{
+  m_packetPayload = packetPayload;
+}
+
+void
+EvalvidSyntheticSource::SetBitrate (double bitrate)
+{
+  NS_LOG_FUNCTION (this << bitrate);
+  m_pendingBitrate = bitrate;
+}
+
+int64_t
+EvalvidSyntheticSource::AssignStreams (int64_t stream)
+{
+  m_uniform->SetStream (stream);
+  m_normal->SetStream (stream + 1);
+  return 2;
+}
+
+void
+EvalvidSyntheticSource::StartChunk (void)
+{
+  if (m_nFrames > 0)
+    {
+      if (m_chunk.duration > 0)
+        {
+          m_chunk.bitrate = m_chunk.bytes * 8 / (m_chunk.duration / 1e6 * 1024);
+        }
+      m_lastChunk = m_chunk;
+      m_lastChunkName = m_chunkName;
+    }
+  m_chunk.firstFrame = m_nFrames;
+  m_chunk.nFrames = 0;
+  m_chunk.bytes = 0;
+  m_chunk.duration = 0;
+  m_chunk.bitrate = 0;
+
+  if (m_bitrate != m_pendingBitrate || m_chunkName.empty ())
+    {
+      m_bitrate = m_pendingBitrate;
+      m_scale = m_model->GetBitrate () > 0 ? m_bitrate / m_model->GetBitrate () : 1;
+      std::ostringstream name;
+      name << "synthetic_" << m_bitrate << "k";
+      m_chunkName = name.str ();
+    }
+}
+
+const EvalvidTraceFrame &
+EvalvidSyntheticSource::GetNextFrame (void)
+{
+  NS_ASSERT (m_model != 0);
+  m_chunkStart = false;
+  if (m_position == 0)
+    {
+      if (m_gops % 3 == 0)
+        {
+          StartChunk ();
+          m_chunkStart = true;
+        }
+      m_gops++;
+      if (m_nFrames == 0 || m_uniform->GetValue () < m_sceneChangeProbability)
+        {
+          // Log-normal factor of mean 1.
+          m_complexity = std::exp (m_sceneComplexity * m_normal->GetValue ()
+                                   - m_sceneComplexity * m_sceneComplexity / 2);
+          m_sceneChange = true;
+        }
+    }
+
+  EvalvidFrameTag::FrameType type = m_model->GetFrameType (m_position);
+  double size = std::exp (m_model->GetLogMean (type)
+                          + m_model->GetLogStdDev (type) * m_normal->GetValue ());
+  if (type != EvalvidFrameTag::H_FRAME)
+    {
+      size *= m_scale * m_complexity;
+    }
+  if (type == EvalvidFrameTag::I_FRAME && m_sceneChange)
+    {
+      size *= m_sceneChangeScale;
+      m_sceneChange = false;
+    }
+  uint32_t frameSize = std::max<uint32_t> (1, (uint32_t) std::min (size + 0.5, 4.0e9));
+
+  m_frame.packetInterval = m_nFrames == 0 ? 0 : m_model->GetFrameInterval (m_position);
+  m_frame.sendTime += m_frame.packetInterval;
+  m_frame.byteOffset += m_frame.frameSize;
+  m_frame.frameId = m_nFrames + 1;
+  m_frame.frameSize = frameSize;
+  // EvalvidServer sends frameSize / payload full fragments and the rest.
+  m_frame.numOfUdpPackets = frameSize / m_packetPayload + 1;
+  m_frame.frameType = type;
+  m_frame.reserved = 0;
+
+  m_chunk.nFrames++;
+  m_chunk.bytes += frameSize;
+  m_chunk.duration += m_frame.packetInterval;
+  m_nFrames++;
+  m_position = (m_position + 1) % m_model->GetGopLength ();
+  return m_frame;
+}
+
+bool
+EvalvidSyntheticSource::IsChunkStart (void) const
+{
+  return m_chunkStart;
+}
+
+const EvalvidChunk &
+EvalvidSyntheticSource::GetLastChunk (void) const
+{
+  return m_lastChunk;
+}
+
+const std::string &
+EvalvidSyntheticSource::GetLastChunkName (void) const
+{
+  return m_lastChunkName;
+}
+
+} // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_SYNTHETIC_SOURCE_H__
+#define __EVALVID_SYNTHETIC_SOURCE_H__
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/random-variable-stream.h"
+#include "evalvid-frame-tag.h"
+#include "evalvid-rendition-catalog.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidVideoModel
+ * \brief Statistical model of a video, fitted on one rendition.
+ *
+ * The sizes of the frames of each type follow a log-normal distribution
+ * whose parameters are those of the trace. The GOP structure, frame types
+ * and intervals, is the first complete GOP of the trace, a GOP starting at
+ * every H frame with a non zero interval (every I frame in traces without
+ * such H frames).
+ */
+class EvalvidVideoModel : public SimpleRefCount<EvalvidVideoModel>
+{
+public:
+  /**
+   * \param rendition a sealed, non empty rendition
+   * \returns the model of the rendition
+   */
+  static Ptr<const EvalvidVideoModel> Fit (const EvalvidRendition &rendition);
+
+  /// \returns the mean bitrate of the fitted rendition (kbit/s)
+  double GetBitrate (void) const;
+  uint32_t GetGopLength (void) const;
+  /// \param position position in the GOP, lower than GetGopLength ()
+  EvalvidFrameTag::FrameType GetFrameType (uint32_t position) const;
+  /// \param position position in the GOP, lower than GetGopLength ()
+  /// \returns microseconds since the previous frame
+  uint32_t GetFrameInterval (uint32_t position) const;
+  /// \returns mean of the logarithm of the sizes of the frames of this type (bytes)
+  double GetLogMean (EvalvidFrameTag::FrameType type) const;
+  /// \returns standard deviation of the logarithm of the sizes of the frames of this type
+  double GetLogStdDev (EvalvidFrameTag::FrameType type) const;
+
+private:
+  EvalvidVideoModel ();
+
+  struct GopFrame
+  {
+    EvalvidFrameTag::FrameType type;
+    uint32_t interval;  // us
+  };
+
+  double m_bitrate;
+  std::vector<GopFrame> m_gop;
+  double m_logMean[EvalvidFrameTag::B_FRAME + 1];
+  double m_logStdDev[EvalvidFrameTag::B_FRAME + 1];
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidSyntheticSource
+ * \brief Endless frame generator of one client, drawing on an EvalvidVideoModel.
+ *
+ * Frames are produced one at a time and nothing is kept about the previous
+ * ones but the totals of the current and last chunk, so the memory does not
+ * grow with the duration of the session. Chunks are three GOPs, as in
+ * EvalvidRendition.
+ *
+ * Any bitrate can be generated: the sizes of the I, P and B frames are
+ * scaled by the ratio of the requested bitrate to the model bitrate; H
+ * frames are headers and keep their size. A bitrate change takes effect at
+ * the next chunk.
+ *
+ * At the start of every GOP a scene change happens with SceneChangeProbability:
+ * the complexity of the new scene, a factor of mean 1 applied to all its
+ * frames, is drawn again, and its first I frame is SceneChangeScale larger.
+ */
+class EvalvidSyntheticSource : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidSyntheticSource ();
+  virtual ~EvalvidSyntheticSource ();
+
+  void SetModel (Ptr<const EvalvidVideoModel> model);
+  Ptr<const EvalvidVideoModel> GetModel (void) const;
+  /// \param packetPayload fragment size used to count the packets of a frame
+  void SetPacketPayload (uint16_t packetPayload);
+  /// \param bitrate bitrate (kbit/s) of the chunks following the current one
+  void SetBitrate (double bitrate);
+
+  /**
+   * \brief generate the next frame
+   * \returns the frame, valid until the next call
+   */
+  const EvalvidTraceFrame &GetNextFrame (void);
+  /// \returns true if the last frame generated is the first of its chunk
+  bool IsChunkStart (void) const;
+  /// \returns the chunk completed before the current one, frame indexes counted since the first frame
+  const EvalvidChunk &GetLastChunk (void) const;
+  /// \returns the name of the rendition the last chunk was generated at
+  const std::string &GetLastChunkName (void) const;
+
+  /**
+   * \param stream first stream index to use
+   * \returns the number of stream indexes used
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Close the current chunk and open a new one at the pending bitrate.
+  void StartChunk (void);
+
+  Ptr<const EvalvidVideoModel> m_model;
+  Ptr<UniformRandomVariable> m_uniform;
+  Ptr<NormalRandomVariable> m_normal;
+  double m_sceneChangeProbability;
+  double m_sceneChangeScale;
+  double m_sceneComplexity;
+  uint16_t m_packetPayload;
+
+  double m_bitrate;         // kbit/s, of the current chunk
+  double m_pendingBitrate;  // kbit/s, of the next chunk
+  double m_scale;           // of the I, P and B frame sizes
+  double m_complexity;      // of the current scene
+  bool m_sceneChange;       // the next I frame opens a scene
+  uint32_t m_position;      // in the GOP, of the next frame
+  uint64_t m_gops;
+  uint64_t m_nFrames;
+  bool m_chunkStart;
+  EvalvidTraceFrame m_frame;
+  EvalvidChunk m_chunk;
+  std::string m_chunkName;
+  EvalvidChunk m_lastChunk;
+  std::string m_lastChunkName;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_SYNTHETIC_SOURCE_H__
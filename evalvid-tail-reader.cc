@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+
+#include "evalvid-tail-reader.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidTailReader");
+
+EvalvidTailReader::EvalvidTailReader ()
+  : m_offset (0),
+    m_hasLine (false)
+{
+}
+
+void
+EvalvidTailReader::SetFileName (const std::string &fileName)
+{
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  m_fileName = fileName;
+  m_offset = 0;
+  m_partial.clear ();
+}
+
+void
+EvalvidTailReader::SetLineCallback (LineCallback cb)
+{
+  m_lineCallback = cb;
+}
+
+uint32_t
+EvalvidTailReader::Poll (void)
+{
+  if (!m_file.is_open ())
+    {
+      m_file.open (m_fileName.c_str (), std::ios::in | std::ios::binary);
+      if (!m_file.is_open ())
+        {
+          return 0;
+        }
+    }
+
+  m_file.clear ();
+  m_file.seekg (0, std::ios::end);
+  std::streamoff size = m_file.tellg ();
+  if (size < m_offset)
+    {
+      NS_LOG_LOGIC ("File " << m_fileName << " was truncated, reading it again");
+      m_offset = 0;
+      m_partial.clear ();
+    }
+  if (size == m_offset)
+    {
+      return 0;
+    }
+
+  m_file.seekg (m_offset, std::ios::beg);
+  uint32_t lines = 0;
+  char buffer[4096];
+  while (m_offset < size)
+    {
+      std::streamsize want = size - m_offset;
+      if (want > (std::streamsize) sizeof (buffer))
+        {
+          want = sizeof (buffer);
+        }
+      m_file.read (buffer, want);
+      std::streamsize got = m_file.gcount ();
+      if (got <= 0)
+        {
+          break;
+        }
+      m_offset += got;
+
+      const char *begin = buffer;
+      const char *end = buffer + got;
+      for (const char *c = begin; c != end; ++c)
+        {
+          if (*c != '\n')
+            {
+              continue;
+            }
+          m_partial.append (begin, c);
+          if (!m_partial.empty ())
+            {
+              m_lastLine.swap (m_partial);
+              m_hasLine = true;
+              lines++;
+              if (!m_lineCallback.IsNull ())
+                {
+                  m_lineCallback (m_lastLine);
+                }
+            }
+          m_partial.clear ();
+          begin = c + 1;
+        }
+      m_partial.append (begin, end);
+    }
+  return lines;
+}
+
+bool
+EvalvidTailReader::HasLine (void) const
+{
+  return m_hasLine;
+}
+
+const std::string &
+EvalvidTailReader::GetLastLine (void) const
+{
+  return m_lastLine;
+}
+
+} // namespace ns3
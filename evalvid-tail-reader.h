@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef __EVALVID_TAIL_READER_H__
+#define __EVALVID_TAIL_READER_H__
+
+#include "ns3/callback.h"
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidTailReader
+ * \brief Incremental reader of a text file that another component appends to.
+ *
+ * Used by the legacy file signalling mode of EvalvidServer and
+ * EvalvidClient. Each Poll reads only the bytes appended since the previous
+ * one, hands every new complete line to the line callback and keeps the
+ * last one, so the cost of a poll is proportional to the new bytes instead
+ * of the file size. If the file shrinks (it was truncated by its writer),
+ * reading restarts from its beginning.
+ */
+class EvalvidTailReader
+{
+public:
+  typedef Callback<void, const std::string &> LineCallback;
+
+  EvalvidTailReader ();
+
+  /// \param fileName the file to follow; it may not exist yet
+  void SetFileName (const std::string &fileName);
+
+  /// \param cb callback invoked for every new complete line
+  void SetLineCallback (LineCallback cb);
+
+  /**
+   * \brief read the lines appended since the last poll
+   * \returns the number of new complete lines
+   */
+  uint32_t Poll (void);
+
+  /// \returns true once at least one complete line was read
+  bool HasLine (void) const;
+
+  /// \returns the last complete line read
+  const std::string &GetLastLine (void) const;
+
+private:
+  std::string    m_fileName;
+  std::ifstream  m_file;
+  std::streamoff m_offset;    // Bytes consumed so far
+  std::string    m_partial;   // Incomplete last line
+  std::string    m_lastLine;
+  bool           m_hasLine;
+  LineCallback   m_lineCallback;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_TAIL_READER_H__
@@ -0,0 +1,83 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/evalvid-buffer-threshold.h"
+
+using namespace ns3;
+
+/**
+ * Precomputes the optimal playback thresholds of EvalvidClient over a grid
+ * of packet arrival rates and variance coefficients, for the client's
+ * ThresholdTable attribute. The default buffer size is the client's 5.6 MB
+ * of 1362 byte packets.
+ *
+ *   ./waf --run "evalvid-threshold-table-generator --output=threshold.evth"
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidThresholdTableGenerator");
+
+int
+main (int argc, char *argv[])
+{
+  std::string output = "threshold.evth";
+  double lamdaMin = 1;
+  double lamdaMax = 200;
+  uint32_t nLamda = 200;
+  double vaMin = 1e-4;
+  double vaMax = 1;
+  uint32_t nVa = 65;
+  uint32_t bufferSize = 4311;
+  uint32_t minB = 5;
+  uint32_t maxB = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("output", "Threshold table file", output);
+  cmd.AddValue ("lamdaMin", "Smallest mean of packet arrivals per interval", lamdaMin);
+  cmd.AddValue ("lamdaMax", "Largest mean of packet arrivals per interval", lamdaMax);
+  cmd.AddValue ("nLamda", "Number of arrival means, linearly spaced", nLamda);
+  cmd.AddValue ("vaMin", "Smallest arrival variance coefficient", vaMin);
+  cmd.AddValue ("vaMax", "Largest arrival variance coefficient", vaMax);
+  cmd.AddValue ("nVa", "Number of variance coefficients, logarithmically spaced", nVa);
+  cmd.AddValue ("bufferSize", "Playback buffer of the client in packets", bufferSize);
+  cmd.AddValue ("minB", "Smallest candidate threshold in packets", minB);
+  cmd.AddValue ("maxB", "Largest candidate threshold in packets", maxB);
+  cmd.Parse (argc, argv);
+
+  if (nLamda < 2 || nVa < 2 || !(lamdaMin < lamdaMax) || !(vaMin > 0 && vaMin < vaMax) || maxB < minB)
+    {
+      std::cerr << "Invalid grid: at least 2 points per axis, increasing bounds and vaMin > 0" << std::endl;
+      return 1;
+    }
+
+  EvalvidBufferThreshold optimizer;
+  optimizer.SetBufferSize (bufferSize);
+  EvalvidThresholdTable table;
+  table.Generate (&optimizer, lamdaMin, lamdaMax, nLamda, vaMin, vaMax, nVa, minB, maxB);
+  if (!table.Save (output))
+    {
+      std::cerr << "Error while writing " << output << std::endl;
+      return 1;
+    }
+  std::cout << output << ": " << nLamda << " x " << nVa << " thresholds" << std::endl;
+  return 0;
+}
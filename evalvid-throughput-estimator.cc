@@ -0,0 +1,343 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+#include "evalvid-throughput-estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidThroughputEstimator");
+
+NS_OBJECT_ENSURE_REGISTERED (EvalvidThroughputEstimator);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidLastSampleEstimator);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidEwmaEstimator);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidHarmonicMeanEstimator);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidPercentileEstimator);
+NS_OBJECT_ENSURE_REGISTERED (EvalvidKalmanEstimator);
+
+// Decades of kbit/s covered by the percentile histogram, from 1 kbit/s.
+static const double PERCENTILE_DECADES = 7.0;
+// Chunk throughput floor of the harmonic mean (kbit/s), keeping the reciprocals finite.
+static const double MIN_CHUNK_THROUGHPUT = 1e-3;
+
+TypeId
+EvalvidThroughputEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidThroughputEstimator")
+    .SetParent<Object> ()
+    ;
+  return tid;
+}
+
+EvalvidThroughputEstimator::EvalvidThroughputEstimator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EvalvidThroughputEstimator::~EvalvidThroughputEstimator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidThroughputEstimator::NotifyChunk (void)
+{
+}
+
+TypeId
+EvalvidLastSampleEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidLastSampleEstimator")
+    .SetParent<EvalvidThroughputEstimator> ()
+    .AddConstructor<EvalvidLastSampleEstimator> ()
+    ;
+  return tid;
+}
+
+EvalvidLastSampleEstimator::EvalvidLastSampleEstimator ()
+  : m_last (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidLastSampleEstimator::AddSample (double throughput, double /* duration */)
+{
+  m_last = throughput;
+}
+
+double
+EvalvidLastSampleEstimator::GetEstimate (void) const
+{
+  return m_last;
+}
+
+TypeId
+EvalvidEwmaEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidEwmaEstimator")
+    .SetParent<EvalvidThroughputEstimator> ()
+    .AddConstructor<EvalvidEwmaEstimator> ()
+    .AddAttribute ("HalfLife",
+                   "Time (s) after which a measure weighs half as much.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&EvalvidEwmaEstimator::m_halfLife),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidEwmaEstimator::EvalvidEwmaEstimator ()
+  : m_halfLife (3.0),
+    m_estimate (0),
+    m_hasSample (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidEwmaEstimator::AddSample (double throughput, double duration)
+{
+  if (!m_hasSample || m_halfLife <= 0)
+    {
+      m_estimate = throughput;
+      m_hasSample = true;
+      return;
+    }
+  double alpha = 1 - std::pow (0.5, duration / m_halfLife);
+  m_estimate += alpha * (throughput - m_estimate);
+}
+
+double
+EvalvidEwmaEstimator::GetEstimate (void) const
+{
+  return m_estimate;
+}
+
+TypeId
+EvalvidHarmonicMeanEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidHarmonicMeanEstimator")
+    .SetParent<EvalvidThroughputEstimator> ()
+    .AddConstructor<EvalvidHarmonicMeanEstimator> ()
+    .AddAttribute ("Chunks",
+                   "Number of chunks the harmonic mean is taken over.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&EvalvidHarmonicMeanEstimator::m_chunks),
+                   MakeUintegerChecker<uint32_t> (1))
+    ;
+  return tid;
+}
+
+EvalvidHarmonicMeanEstimator::EvalvidHarmonicMeanEstimator ()
+  : m_chunks (5),
+    m_next (0),
+    m_count (0),
+    m_sum (0),
+    m_chunkData (0),
+    m_chunkDuration (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidHarmonicMeanEstimator::AddSample (double throughput, double duration)
+{
+  m_chunkData += throughput * duration;
+  m_chunkDuration += duration;
+}
+
+void
+EvalvidHarmonicMeanEstimator::NotifyChunk (void)
+{
+  if (m_chunkDuration <= 0)
+    {
+      return;
+    }
+  if (m_inverses.size () != m_chunks)
+    {
+      // First chunk, or the attribute changed.
+      m_inverses.assign (m_chunks, 0);
+      m_next = 0;
+      m_count = 0;
+      m_sum = 0;
+    }
+  double inverse = 1 / std::max (m_chunkData / m_chunkDuration, MIN_CHUNK_THROUGHPUT);
+  if (m_count == m_chunks)
+    {
+      m_sum -= m_inverses[m_next];
+    }
+  else
+    {
+      m_count++;
+    }
+  m_inverses[m_next] = inverse;
+  m_sum += inverse;
+  m_next = (m_next + 1) % m_chunks;
+  m_chunkData = 0;
+  m_chunkDuration = 0;
+}
+
+double
+EvalvidHarmonicMeanEstimator::GetEstimate (void) const
+{
+  if (m_count > 0)
+    {
+      return m_count / m_sum;
+    }
+  return m_chunkDuration > 0 ? m_chunkData / m_chunkDuration : 0;
+}
+
+TypeId
+EvalvidPercentileEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidPercentileEstimator")
+    .SetParent<EvalvidThroughputEstimator> ()
+    .AddConstructor<EvalvidPercentileEstimator> ()
+    .AddAttribute ("Window",
+                   "Number of measures of the sliding window.",
+                   UintegerValue (25),
+                   MakeUintegerAccessor (&EvalvidPercentileEstimator::m_window),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Percentile",
+                   "Percentile of the window taken as the estimate, in [0, 1].",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&EvalvidPercentileEstimator::m_percentile),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    ;
+  return tid;
+}
+
+EvalvidPercentileEstimator::EvalvidPercentileEstimator ()
+  : m_window (25),
+    m_percentile (0.5),
+    m_histogram (BINS, 0),
+    m_next (0),
+    m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidPercentileEstimator::AddSample (double throughput, double /* duration */)
+{
+  if (m_samples.size () != m_window)
+    {
+      m_samples.assign (m_window, 0);
+      m_histogram.assign (BINS, 0);
+      m_next = 0;
+      m_count = 0;
+    }
+  double position = throughput > 1 ? std::log10 (throughput) / PERCENTILE_DECADES * BINS : 0;
+  uint16_t bin = (uint16_t) std::min<double> (position, BINS - 1);
+  if (m_count == m_window)
+    {
+      m_histogram[m_samples[m_next]]--;
+    }
+  else
+    {
+      m_count++;
+    }
+  m_samples[m_next] = bin;
+  m_histogram[bin]++;
+  m_next = (m_next + 1) % m_window;
+}
+
+double
+EvalvidPercentileEstimator::GetEstimate (void) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint32_t rank = std::max<uint32_t> (1, (uint32_t) std::ceil (m_percentile * m_count));
+  uint32_t seen = 0;
+  uint32_t bin = 0;
+  for (; bin < BINS - 1; bin++)
+    {
+      seen += m_histogram[bin];
+      if (seen >= rank)
+        {
+          break;
+        }
+    }
+  // Geometric centre of the bin.
+  return std::pow (10.0, (bin + 0.5) * PERCENTILE_DECADES / BINS);
+}
+
+TypeId
+EvalvidKalmanEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EvalvidKalmanEstimator")
+    .SetParent<EvalvidThroughputEstimator> ()
+    .AddConstructor<EvalvidKalmanEstimator> ()
+    .AddAttribute ("ProcessNoise",
+                   "Growth of the variance of the throughput per second ((kbit/s)^2/s).",
+                   DoubleValue (1e5),
+                   MakeDoubleAccessor (&EvalvidKalmanEstimator::m_processNoise),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MeasurementNoise",
+                   "Variance of a measure ((kbit/s)^2).",
+                   DoubleValue (1e5),
+                   MakeDoubleAccessor (&EvalvidKalmanEstimator::m_measurementNoise),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+EvalvidKalmanEstimator::EvalvidKalmanEstimator ()
+  : m_processNoise (1e5),
+    m_measurementNoise (1e5),
+    m_estimate (0),
+    m_variance (0),
+    m_hasSample (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EvalvidKalmanEstimator::AddSample (double throughput, double duration)
+{
+  if (!m_hasSample)
+    {
+      m_estimate = throughput;
+      m_variance = m_measurementNoise;
+      m_hasSample = true;
+      return;
+    }
+  double predicted = m_variance + m_processNoise * duration;
+  double gain = predicted + m_measurementNoise > 0 ? predicted / (predicted + m_measurementNoise) : 1;
+  m_estimate += gain * (throughput - m_estimate);
+  m_variance = (1 - gain) * predicted;
+}
+
+double
+EvalvidKalmanEstimator::GetEstimate (void) const
+{
+  return m_estimate;
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_THROUGHPUT_ESTIMATOR_H__
+#define __EVALVID_THROUGHPUT_ESTIMATOR_H__
+
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidThroughputEstimator
+ * \brief Base class of the throughput estimators of EvalvidClient.
+ *
+ * The client measures the throughput over intervals of at least 0.2 s and
+ * hands every measure to the estimator; its rate decisions and feedback use
+ * the estimate. Every update is constant time.
+ */
+class EvalvidThroughputEstimator : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidThroughputEstimator ();
+  virtual ~EvalvidThroughputEstimator ();
+
+  /**
+   * \param throughput throughput measured over the interval (kbit/s)
+   * \param duration length of the interval (s)
+   */
+  virtual void AddSample (double throughput, double duration) = 0;
+  /// A new chunk started.
+  virtual void NotifyChunk (void);
+  /// \returns the estimated throughput (kbit/s), 0 before the first sample
+  virtual double GetEstimate (void) const = 0;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidLastSampleEstimator
+ * \brief The last measure, as EvalvidClient always used.
+ */
+class EvalvidLastSampleEstimator : public EvalvidThroughputEstimator
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidLastSampleEstimator ();
+
+  virtual void AddSample (double throughput, double duration);
+  virtual double GetEstimate (void) const;
+
+private:
+  double m_last;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidEwmaEstimator
+ * \brief Exponentially weighted moving average with a half-life in seconds.
+ *
+ * A measure over d seconds has the weight 1 - 0.5^(d / half-life), so the
+ * average does not depend on how often the client measures.
+ */
+class EvalvidEwmaEstimator : public EvalvidThroughputEstimator
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidEwmaEstimator ();
+
+  virtual void AddSample (double throughput, double duration);
+  virtual double GetEstimate (void) const;
+
+private:
+  double m_halfLife;  // s
+  double m_estimate;
+  bool m_hasSample;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidHarmonicMeanEstimator
+ * \brief Harmonic mean of the throughput of the last chunks (as FESTIVE).
+ *
+ * The throughput of a chunk is the data received during it over its
+ * duration. The reciprocals of the last chunks are kept in a ring with
+ * their running sum; until the first chunk ends the current one is used.
+ */
+class EvalvidHarmonicMeanEstimator : public EvalvidThroughputEstimator
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidHarmonicMeanEstimator ();
+
+  virtual void AddSample (double throughput, double duration);
+  virtual void NotifyChunk (void);
+  virtual double GetEstimate (void) const;
+
+private:
+  uint32_t m_chunks;
+  std::vector<double> m_inverses;  // 1 / throughput of the last chunks
+  uint32_t m_next;
+  uint32_t m_count;
+  double m_sum;
+  double m_chunkData;      // kbit
+  double m_chunkDuration;  // s
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidPercentileEstimator
+ * \brief Percentile of the measures of a sliding window.
+ *
+ * The measures are counted in a histogram of logarithmic bins, each 3.2%
+ * wide, from 1 kbit/s to 10 Gbit/s; a ring of bin indices removes the
+ * oldest measure when the window is full. Updates are constant time, and
+ * an estimate walks the fixed number of bins.
+ */
+class EvalvidPercentileEstimator : public EvalvidThroughputEstimator
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidPercentileEstimator ();
+
+  virtual void AddSample (double throughput, double duration);
+  virtual double GetEstimate (void) const;
+
+private:
+  static const uint32_t BINS = 512;
+
+  uint32_t m_window;
+  double m_percentile;
+  std::vector<uint32_t> m_histogram;
+  std::vector<uint16_t> m_samples;  // Bins of the last measures
+  uint32_t m_next;
+  uint32_t m_count;
+};
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidKalmanEstimator
+ * \brief Scalar Kalman filter tracking the throughput as a random walk.
+ *
+ * The variance of the state grows by ProcessNoise per second between
+ * measures; each measure has the variance MeasurementNoise. The gain thus
+ * adapts to the measuring period and settles where both balance.
+ */
+class EvalvidKalmanEstimator : public EvalvidThroughputEstimator
+{
+public:
+  static TypeId GetTypeId (void);
+  EvalvidKalmanEstimator ();
+
+  virtual void AddSample (double throughput, double duration);
+  virtual double GetEstimate (void) const;
+
+private:
+  double m_processNoise;      // (kbit/s)^2 / s
+  double m_measurementNoise;  // (kbit/s)^2
+  double m_estimate;
+  double m_variance;
+  bool m_hasSample;
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_THROUGHPUT_ESTIMATOR_H__
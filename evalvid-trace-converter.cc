@@ -0,0 +1,48 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/evalvid-rendition-catalog.h"
+#include "ns3/evalvid-file-converter.h"
+
+using namespace ns3;
+
+/**
+ * Converts mp4trace text files (st_*.st) to the binary trace format loaded
+ * by EvalvidServer. Each output is written next to its input as
+ * "<input>.evtb", unless --output is given for a single input.
+ *
+ *   ./waf --run "evalvid-trace-converter --input=st_foreman_cif_2M.st"
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvalvidTraceConverter");
+
+int
+main (int argc, char *argv[])
+{
+  EvalvidFileConversion conversion;
+  conversion.usage = "evalvid-trace-converter --input=file.st[,file.st...] [--output=file.evtb]";
+  conversion.inputHelp = "Comma separated mp4trace text files";
+  conversion.outputHelp = "Binary trace file, when a single input is given";
+  conversion.convert = &EvalvidRenditionCatalog::ConvertTextTrace;
+  conversion.outputName = &EvalvidRenditionCatalog::GetBinaryFileName;
+  return EvalvidRunFileConverter (argc, argv, conversion);
+}
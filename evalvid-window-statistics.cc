@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#include "ns3/abort.h"
+
+#include "evalvid-window-statistics.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+EvalvidWindowStatistics::EvalvidWindowStatistics ()
+  : m_samples (1),
+    m_next (0),
+    m_count (0),
+    m_mean (0),
+    m_m2 (0)
+{
+}
+
+void
+EvalvidWindowStatistics::SetWindow (uint32_t samples)
+{
+  NS_ABORT_MSG_IF (samples == 0, "EvalvidWindowStatistics: empty window");
+  m_samples.assign (samples, 0);
+  Clear ();
+}
+
+uint32_t
+EvalvidWindowStatistics::GetWindow (void) const
+{
+  return m_samples.size ();
+}
+
+void
+EvalvidWindowStatistics::Add (double x)
+{
+  if (m_count < m_samples.size ())
+    {
+      m_count++;
+      double delta = x - m_mean;
+      m_mean += delta / m_count;
+      m_m2 += delta * (x - m_mean);
+    }
+  else
+    {
+      // Replace the oldest sample y: the mean moves by (x - y) / n and the
+      // squared deviations by (x - y) (x - mean' + y - mean).
+      double y = m_samples[m_next];
+      double mean = m_mean + (x - y) / m_count;
+      m_m2 += (x - y) * (x - mean + y - m_mean);
+      m_mean = mean;
+    }
+  m_samples[m_next] = x;
+  m_next = (m_next + 1) % m_samples.size ();
+}
+
+void
+EvalvidWindowStatistics::Clear (void)
+{
+  m_next = 0;
+  m_count = 0;
+  m_mean = 0;
+  m_m2 = 0;
+}
+
+uint32_t
+EvalvidWindowStatistics::GetCount (void) const
+{
+  return m_count;
+}
+
+bool
+EvalvidWindowStatistics::IsFull (void) const
+{
+  return m_count == m_samples.size ();
+}
+
+double
+EvalvidWindowStatistics::GetMean (void) const
+{
+  return m_mean;
+}
+
+double
+EvalvidWindowStatistics::GetVariance (void) const
+{
+  // Rounding of the replacements can leave a tiny negative sum.
+  return m_count > 0 ? std::max (m_m2, 0.0) / m_count : 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+#ifndef __EVALVID_WINDOW_STATISTICS_H__
+#define __EVALVID_WINDOW_STATISTICS_H__
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup Evalvid
+ * \class EvalvidWindowStatistics
+ * \brief Mean and variance of the last samples of a series.
+ *
+ * Samples are kept in a fixed ring of the window size. Welford's update
+ * adds a sample to the running mean and sum of squared deviations, and
+ * once the window is full the oldest sample is replaced in the same step,
+ * so every Add is constant time and memory does not grow with the session.
+ */
+class EvalvidWindowStatistics
+{
+public:
+  EvalvidWindowStatistics ();
+
+  /// \param samples window size, at least 1; clears the samples
+  void SetWindow (uint32_t samples);
+  uint32_t GetWindow (void) const;
+
+  /// \param x the new sample, replacing the oldest one if the window is full
+  void Add (double x);
+  /// Forget every sample.
+  void Clear (void);
+
+  /// \returns the number of samples in the window
+  uint32_t GetCount (void) const;
+  bool IsFull (void) const;
+  /// \returns the mean of the samples, 0 without samples
+  double GetMean (void) const;
+  /// \returns the population variance of the samples, 0 without samples
+  double GetVariance (void) const;
+
+private:
+  std::vector<double> m_samples;
+  uint32_t m_next;   //!< Slot of the next sample.
+  uint32_t m_count;
+  double m_mean;
+  double m_m2;       //!< Sum of squared deviations from the mean.
+};
+
+} // namespace ns3
+
+#endif // __EVALVID_WINDOW_STATISTICS_H__
@@ -25,6 +25,8 @@
 #include "ns3/lte-rlc-um.h"
 #include "ns3/lte-rlc-sdu-status-tag.h"
 #include "ns3/lte-rlc-tag.h"
+#include "ns3/evalvid-frame-tag.h"
+#include "ns3/evalvid-hint-bus.h"
 #include <fstream>
 using namespace std;
 namespace ns3 {
@@ -35,6 +37,7 @@ NS_OBJECT_ENSURE_REGISTERED (LteRlcUm);
 
 LteRlcUm::LteRlcUm ()
   : m_maxTxBufferSize (10 * 1024),
+    m_hintCellId (0),
     m_txBufferSize (0),
     m_sequenceNumber (0),
     m_vrUr (0),
@@ -57,13 +60,6 @@ LteRlcUm::LteRlcUm ()
   m_pPrevFrame = 0;
   m_pPPrevFrame = 0;
   m_nackCount = 0;
-  m_videoRateFileName = "videoRate";
-  m_videoRateFile.open(m_videoRateFileName.c_str(), ios::out);
-  if (m_videoRateFile.fail())
-   {
-     NS_FATAL_ERROR(">> EvalvidServer: Error while opening video rate file: " << m_videoRateFileName.c_str());
-     return;
-   }
 }
 
 LteRlcUm::~LteRlcUm ()
@@ -83,6 +79,12 @@ LteRlcUm::GetTypeId (void)
                    UintegerValue (10 * 1024),
                    MakeUintegerAccessor (&LteRlcUm::m_maxTxBufferSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HintCellId",
+                   "Cell of the eNB this instance belongs to. Only instances with a cell, "
+                   "i.e. on the eNB side, publish EvalvidCongestionHint; 0 publishes none.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&LteRlcUm::m_hintCellId),
+                   MakeUintegerChecker<uint16_t> ())
     ;
   return tid;
 }
@@ -140,36 +142,26 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << m_rnti << (uint32_t) m_lcid << p->GetSize ());
   NS_LOG_LOGIC ("UMErrorModel(): "<<UMErrorModel());
-  /** Chun: Read frameType from the file named videoType */
-  uint32_t frameId;
-  uint32_t Uid;
-  string frameType;
-  string nextFrameType;
-  uint32_t frameSize;
-  
-  m_revVideoTypeFileName = "videoType";
-  ifstream revVideoTypeFile(m_revVideoTypeFileName.c_str(), ios::in);
-  if (revVideoTypeFile.fail())
+  /** Chun: Read frameType from the frame tag attached by EvalvidServer */
+  EvalvidFrameTag frameTag;
+  if (p->PeekPacketTag (frameTag))
     {
-      NS_FATAL_ERROR(">> EvalvidServer: Error while opening receive video trace file: " << m_revVideoTypeFileName.c_str());
-      return;
-  }
-  while (revVideoTypeFile >> frameId >> Uid >> frameType >> frameSize)
+      m_frameType = frameTag.GetFrameType ();
+      m_frameSize = frameTag.GetFrameSize ();
+      m_frameId = frameTag.GetFrameId ();
+    }
+  else
     {
-      if(Uid == p->GetUid()) {
-          m_frameType = frameType;
-          m_frameSize = frameSize;
-          m_frameId = frameId;
-      }
-      if(frameId == m_frameId + 1) {
-          nextFrameType = frameType;
-      }
+      m_frameType = EvalvidFrameTag::UNKNOWN_FRAME;
     }
   if(p->GetUid() == 0){
-    m_frameType = "H";
+    m_frameType = EvalvidFrameTag::H_FRAME;
   }
-  NS_LOG_LOGIC (" Pid: "<< m_frameId<<" Uid: "<< p->GetUid()  <<" Frame Type: " << m_frameType << " FrameSize: " <<m_frameSize << " nextFrameType:     "<<nextFrameType );
+  NS_LOG_LOGIC (" Fid: "<< m_frameId<<" Uid: "<< p->GetUid()  <<" Frame Type: " << EvalvidFrameTag::GetFrameTypeString (m_frameType)
+                << " FrameSize: " <<m_frameSize << " GOP position: " << frameTag.GetGopPosition ()
+                << " chunk: " << frameTag.GetChunkIndex ());
 
+  EvalvidCongestionHint::Event event = EvalvidCongestionHint::QUEUED;
   if (m_txBufferSize + p->GetSize () <= m_maxTxBufferSize)
     {
       if(0 == UMErrorModel()) {
@@ -243,13 +235,14 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
       m_pPrevFrame = m_prevFrame;
       m_prevFrame = 1;
       } else {        
-        NS_LOG_LOGIC ("Wireless discarded "<< m_frameId <<". frame type: " << m_frameType);
+        event = EvalvidCongestionHint::WIRELESS_LOSS;
+        NS_LOG_LOGIC ("Wireless discarded "<< m_frameId <<". frame type: " << EvalvidFrameTag::GetFrameTypeString (m_frameType));
         m_nackNum++;
         m_nackCount++;
         m_pPPrevFrame = m_pPrevFrame;
         m_pPrevFrame = m_prevFrame;
         m_prevFrame = 0;
-        if(m_frameType.compare("H") == 0 ){
+        if(m_frameType == EvalvidFrameTag::H_FRAME ){
           m_hBuffer.push_back(p);
         } else {
           m_pBuffer.push_back(p);
@@ -258,13 +251,13 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
     }
   else
     {
-      if(m_frameType.compare("H") == 0 ){
+      if(m_frameType == EvalvidFrameTag::H_FRAME ){
           m_hBuffer.push_back(p);
       } else {
           m_pBuffer.push_back(p);
       }
       // Discard full RLC SDU
-      NS_LOG_LOGIC ("TxBuffer is full. RLC SDU discarded "<< m_frameId <<". frame type: " << m_frameType);
+      NS_LOG_LOGIC ("TxBuffer is full. RLC SDU discarded "<< m_frameId <<". frame type: " << EvalvidFrameTag::GetFrameTypeString (m_frameType));
       NS_LOG_LOGIC ("MaxTxBufferSize = " << m_maxTxBufferSize);
       NS_LOG_LOGIC ("txBufferSize    = " << m_txBufferSize);
       NS_LOG_LOGIC ("packet size     = " << p->GetSize ());
@@ -276,12 +269,28 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
       if((m_prevFrame == 0 && m_pPrevFrame == 0 && m_pPPrevFrame == 0)) {
         /** Chun: Congestion packet loss: adjust video rate */
         NS_LOG_LOGIC ("Congestion packet loss: " << m_frameId );
-        m_videoRateFile  << 40 << std::endl; 
+        event = EvalvidCongestionHint::CONGESTION_LOSS;
       } else {
-        m_videoRateFile  << 52 << std::endl; 
+        event = EvalvidCongestionHint::BUFFER_FULL;
       }
     }
-  NS_LOG_LOGIC ("calNackRatio(): "<<calNackRatio()<<" m_nackNum: "<<m_nackNum);
+  double nackRatio = calNackRatio ();
+  NS_LOG_LOGIC ("calNackRatio(): "<<nackRatio<<" m_nackNum: "<<m_nackNum);
+
+  /** Chun: publish the tx buffer state for the video server */
+  if (m_hintCellId != 0)
+    {
+      EvalvidCongestionHint hint;
+      hint.cellId = m_hintCellId;
+      hint.rnti = m_rnti;
+      hint.lcid = m_lcid;
+      hint.event = event;
+      hint.txBufferSize = m_txBufferSize;
+      hint.maxTxBufferSize = m_maxTxBufferSize;
+      hint.nackRatio = nackRatio;
+      EvalvidHintBus::Get ()->Publish (hint);
+    }
+
   /** Report Buffer Status */
   DoReportBufferStatus ();
   m_rbsTimer.Cancel ();
@@ -23,6 +23,7 @@
 
 #include "ns3/lte-rlc-sequence-number.h"
 #include "ns3/lte-rlc.h"
+#include "ns3/evalvid-frame-tag.h"
 
 #include <ns3/event-id.h>
 #include <map>
@@ -74,6 +75,7 @@ private:
 
 private:
   uint32_t m_maxTxBufferSize;
+  uint16_t m_hintCellId;  // cell of the eNB-side instance, 0 on the UE side
   uint32_t m_txBufferSize;
   std::vector < Ptr<Packet> > m_txBuffer;       // Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; // Reception buffer
@@ -109,10 +111,7 @@ private:
   uint32_t MINPDUs;
   double m_ratio;
   double calNackRatio();
-  string m_videoRateFileName;
-  ofstream m_videoRateFile;
-  string m_revVideoTypeFileName;
-  string m_frameType;
+  EvalvidFrameTag::FrameType m_frameType;
   uint32_t m_frameSize;
   uint32_t m_frameId;
   uint32_t m_prevFrame;